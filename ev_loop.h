@@ -0,0 +1,431 @@
+#ifndef EV_LOOP_H_20261018
+#define EV_LOOP_H_20261018
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "list.h"
+/*
+ * Single-threaded epoll event loop with intrusive watcher lists.
+ *
+ * Watchers embed their list_head, so registering, arming and firing
+ * allocate nothing.  Each iteration:
+ *  - epoll_wait() results are queued on @ready, then the whole queue is
+ *    taken with list_splice_init() and run as one batch;
+ *  - due timers are taken from a hashed timer wheel, one slot per tick,
+ *    so starting and stopping a timer is O(1);
+ *  - deferred work queued with ev_defer() is drained the same way.
+ * Other threads hand work to the loop with ev_post(), which queues it
+ * under a mutex and wakes the loop through an eventfd.
+ *
+ * A callback may start or stop any watcher, including ones in the batch
+ * being run: batches are consumed from the front, and stopping a watcher
+ * unlinks it from whatever batch it is on.
+ */
+
+#define EV_MAX_EVENTS 256
+#define EV_WHEEL_BITS 8
+#define EV_WHEEL_SIZE (1 << EV_WHEEL_BITS)
+#define EV_WHEEL_MASK (EV_WHEEL_SIZE - 1)
+
+struct ev_loop;
+
+struct ev_io {
+  struct list_head node; /* on the ready queue while pending */
+  int fd;
+  uint32_t events;  /* EPOLLIN | EPOLLOUT | ... */
+  uint32_t revents; /* pending events */
+  int active;
+  void (*cb)(struct ev_loop *loop, struct ev_io *io, uint32_t revents);
+};
+
+struct ev_timer {
+  struct list_head node; /* on a wheel slot while armed */
+  uint64_t expires;      /* tick */
+  uint64_t repeat;       /* ticks, 0 for one-shot */
+  void (*cb)(struct ev_loop *loop, struct ev_timer *timer);
+};
+
+struct ev_work {
+  struct list_head node;
+  void (*fn)(struct ev_loop *loop, struct ev_work *work);
+};
+
+struct ev_loop {
+  int epfd;
+  int stop;
+  unsigned tick_ms;
+  uint64_t start_ms;
+  uint64_t tick; /* last tick processed */
+  size_t nr_timers;
+  struct list_head ready;
+  struct list_head deferred;
+  struct list_head wheel[EV_WHEEL_SIZE];
+
+  /* cross-thread wakeups */
+  struct ev_io wakeup;
+  pthread_mutex_t post_lock;
+  struct list_head posted;
+
+  struct epoll_event events[EV_MAX_EVENTS];
+};
+
+static uint64_t ev_now_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* Tick that has started by now. */
+static uint64_t __ev_current_tick(const struct ev_loop *loop) {
+  return (ev_now_ms() - loop->start_ms) / loop->tick_ms;
+}
+
+/**
+ * ev_io_init - prepare an I/O watcher
+ * @io: the watcher.
+ * @fd: the file descriptor to watch, ideally non-blocking.
+ * @cb: called with the pending events.
+ */
+static void ev_io_init(struct ev_io *io, int fd,
+                       void (*cb)(struct ev_loop *, struct ev_io *,
+                                  uint32_t)) {
+  INIT_LIST_HEAD(&io->node);
+  io->fd = fd;
+  io->events = 0;
+  io->revents = 0;
+  io->active = 0;
+  io->cb = cb;
+}
+
+/**
+ * ev_io_start - watch a descriptor, or change the watched events
+ * @loop: the loop.
+ * @io: the watcher.
+ * @events: epoll events, level-triggered unless EPOLLET is included.
+ *
+ * Returns 0 or a negative errno.
+ */
+static int ev_io_start(struct ev_loop *loop, struct ev_io *io,
+                       uint32_t events) {
+  struct epoll_event ev;
+
+  ev.events = events;
+  ev.data.ptr = io;
+  if (epoll_ctl(loop->epfd, io->active ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                io->fd, &ev))
+    return -errno;
+  io->events = events;
+  io->active = 1;
+  return 0;
+}
+
+/**
+ * ev_io_stop - stop watching a descriptor
+ * @loop: the loop.
+ * @io: the watcher; any pending events are dropped.
+ *
+ * Must be called before the descriptor is closed.
+ */
+static void ev_io_stop(struct ev_loop *loop, struct ev_io *io) {
+  if (!io->active) return;
+  epoll_ctl(loop->epfd, EPOLL_CTL_DEL, io->fd, NULL);
+  list_del_init(&io->node);
+  io->revents = 0;
+  io->active = 0;
+}
+
+/**
+ * ev_timer_init - prepare a timer
+ * @timer: the timer.
+ * @cb: called when the timer fires.
+ */
+static void ev_timer_init(struct ev_timer *timer,
+                          void (*cb)(struct ev_loop *, struct ev_timer *)) {
+  INIT_LIST_HEAD(&timer->node);
+  timer->expires = 0;
+  timer->repeat = 0;
+  timer->cb = cb;
+}
+
+/**
+ * ev_timer_active - tests whether a timer is armed
+ * @timer: the timer.
+ */
+static int ev_timer_active(const struct ev_timer *timer) {
+  return !list_empty(&timer->node);
+}
+
+static void __ev_timer_add(struct ev_loop *loop, struct ev_timer *timer) {
+  list_add_tail(&timer->node, &loop->wheel[timer->expires & EV_WHEEL_MASK]);
+  loop->nr_timers++;
+}
+
+/**
+ * ev_timer_stop - disarm a timer
+ * @loop: the loop.
+ * @timer: the timer.
+ */
+static void ev_timer_stop(struct ev_loop *loop, struct ev_timer *timer) {
+  if (!ev_timer_active(timer)) return;
+  list_del_init(&timer->node);
+  loop->nr_timers--;
+}
+
+/**
+ * ev_timer_start - arm a timer
+ * @loop: the loop.
+ * @timer: the timer, re-armed if already active.
+ * @after_ms: delay before the first expiry, rounded up to a tick.
+ * @repeat_ms: period after that, 0 for a one-shot timer.
+ */
+static void ev_timer_start(struct ev_loop *loop, struct ev_timer *timer,
+                           uint64_t after_ms, uint64_t repeat_ms) {
+  uint64_t ticks = (after_ms + loop->tick_ms - 1) / loop->tick_ms;
+
+  ev_timer_stop(loop, timer);
+  timer->expires = __ev_current_tick(loop) + (ticks ? ticks : 1);
+  timer->repeat = (repeat_ms + loop->tick_ms - 1) / loop->tick_ms;
+  if (repeat_ms && !timer->repeat) timer->repeat = 1;
+  __ev_timer_add(loop, timer);
+}
+
+/**
+ * ev_work_init - prepare a work item
+ * @work: the work item.
+ * @fn: called once per ev_defer() or ev_post().
+ */
+static void ev_work_init(struct ev_work *work,
+                         void (*fn)(struct ev_loop *, struct ev_work *)) {
+  INIT_LIST_HEAD(&work->node);
+  work->fn = fn;
+}
+
+/**
+ * ev_defer - run a work item on the next loop iteration
+ * @loop: the loop.
+ * @work: the work item; ignored if already queued.
+ *
+ * Only from the loop thread.
+ */
+static void ev_defer(struct ev_loop *loop, struct ev_work *work) {
+  if (list_empty(&work->node)) list_add_tail(&work->node, &loop->deferred);
+}
+
+/**
+ * ev_post - hand a work item to the loop from any thread
+ * @loop: the loop.
+ * @work: the work item; must not be queued already.
+ *
+ * The eventfd is only written when the posted queue goes from empty to
+ * non-empty, so a burst of posts costs one wakeup.
+ */
+static void ev_post(struct ev_loop *loop, struct ev_work *work) {
+  uint64_t one = 1;
+  int was_empty;
+
+  pthread_mutex_lock(&loop->post_lock);
+  was_empty = list_empty(&loop->posted);
+  list_add_tail(&work->node, &loop->posted);
+  pthread_mutex_unlock(&loop->post_lock);
+  if (was_empty && write(loop->wakeup.fd, &one, sizeof(one)) < 0) {
+    /* counter overflow only; the loop is already awake */
+  }
+}
+
+static void __ev_wakeup_cb(struct ev_loop *loop, struct ev_io *io,
+                           uint32_t revents) {
+  uint64_t n;
+
+  if (read(io->fd, &n, sizeof(n)) < 0) {
+    /* EAGAIN: a previous read already consumed it */
+  }
+  pthread_mutex_lock(&loop->post_lock);
+  list_splice_tail_init(&loop->posted, &loop->deferred);
+  pthread_mutex_unlock(&loop->post_lock);
+}
+
+/**
+ * ev_loop_init - create a loop
+ * @loop: the loop to initialize.
+ * @tick_ms: timer resolution, 0 for 1 ms.
+ *
+ * Returns 0 or a negative errno.
+ */
+static int ev_loop_init(struct ev_loop *loop, unsigned tick_ms) {
+  int i, efd, err;
+
+  loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (loop->epfd < 0) return -errno;
+  efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (efd < 0) {
+    err = -errno;
+    close(loop->epfd);
+    return err;
+  }
+  loop->stop = 0;
+  loop->tick_ms = tick_ms ? tick_ms : 1;
+  loop->start_ms = ev_now_ms();
+  loop->tick = 0;
+  loop->nr_timers = 0;
+  INIT_LIST_HEAD(&loop->ready);
+  INIT_LIST_HEAD(&loop->deferred);
+  for (i = 0; i < EV_WHEEL_SIZE; i++) INIT_LIST_HEAD(&loop->wheel[i]);
+  pthread_mutex_init(&loop->post_lock, NULL);
+  INIT_LIST_HEAD(&loop->posted);
+  ev_io_init(&loop->wakeup, efd, __ev_wakeup_cb);
+  err = ev_io_start(loop, &loop->wakeup, EPOLLIN);
+  if (err) {
+    close(efd);
+    close(loop->epfd);
+    return err;
+  }
+  return 0;
+}
+
+/**
+ * ev_loop_destroy - release the loop's descriptors
+ * @loop: the loop; watchers still registered are simply forgotten.
+ */
+static void ev_loop_destroy(struct ev_loop *loop) {
+  close(loop->wakeup.fd);
+  close(loop->epfd);
+  pthread_mutex_destroy(&loop->post_lock);
+}
+
+/**
+ * ev_loop_stop - make ev_loop_run() return after the current iteration
+ * @loop: the loop.
+ *
+ * Only from the loop thread; other threads can ev_post() a work item
+ * that calls it.
+ */
+static void ev_loop_stop(struct ev_loop *loop) { loop->stop = 1; }
+
+static void __ev_run_timers(struct ev_loop *loop) {
+  struct list_head batch = LIST_HEAD_INIT(batch);
+  struct ev_timer *timer;
+  uint64_t now = __ev_current_tick(loop);
+
+  /*
+   * One lap visits every slot, so after a long sleep only the last lap
+   * is walked, and nothing at all without timers.  Every timer due by
+   * @now is found in the slots of (now - EV_WHEEL_SIZE, now].
+   */
+  if (!loop->nr_timers || now - loop->tick > EV_WHEEL_SIZE)
+    loop->tick = loop->nr_timers ? now - EV_WHEEL_SIZE : now;
+  while (loop->tick < now) {
+    loop->tick++;
+    list_splice_init(&loop->wheel[loop->tick & EV_WHEEL_MASK], &batch);
+    while (!list_empty(&batch)) {
+      timer = list_first_entry(&batch, struct ev_timer, node);
+      list_del_init(&timer->node);
+      if (timer->expires > now) {
+        /* a later lap of the wheel */
+        list_add_tail(&timer->node,
+                      &loop->wheel[timer->expires & EV_WHEEL_MASK]);
+        continue;
+      }
+      loop->nr_timers--;
+      if (timer->repeat) {
+        /* after a stall, skip the missed periods rather than replay them */
+        timer->expires = now + timer->repeat;
+        __ev_timer_add(loop, timer);
+      }
+      timer->cb(loop, timer);
+    }
+  }
+}
+
+static void __ev_run_deferred(struct ev_loop *loop) {
+  struct list_head batch = LIST_HEAD_INIT(batch);
+  struct ev_work *work;
+
+  /* work deferred by these callbacks waits for the next iteration */
+  list_splice_init(&loop->deferred, &batch);
+  while (!list_empty(&batch)) {
+    work = list_first_entry(&batch, struct ev_work, node);
+    list_del_init(&work->node);
+    work->fn(loop, work);
+  }
+}
+
+/*
+ * Milliseconds until the first non-empty wheel slot comes due, -1 with
+ * no timers.  A slot may only hold timers for a later lap, in which case
+ * the loop wakes early and waits again.
+ */
+static int __ev_timeout(const struct ev_loop *loop) {
+  uint64_t t, due, now;
+
+  if (!loop->nr_timers) return -1;
+  for (t = loop->tick + 1; t <= loop->tick + EV_WHEEL_SIZE; t++)
+    if (!list_empty(&loop->wheel[t & EV_WHEEL_MASK])) break;
+  due = loop->start_ms + t * loop->tick_ms;
+  now = ev_now_ms();
+  return due > now ? (int)(due - now) : 0;
+}
+
+/**
+ * ev_loop_run_once - run one iteration
+ * @loop: the loop.
+ * @block: wait for events if nothing is pending.
+ *
+ * Returns the number of I/O events handled, or a negative errno from
+ * epoll_wait().
+ */
+static int ev_loop_run_once(struct ev_loop *loop, int block) {
+  struct list_head batch = LIST_HEAD_INIT(batch);
+  struct ev_io *io;
+  uint32_t revents;
+  int i, n, timeout = 0;
+
+  if (block && list_empty(&loop->deferred)) timeout = __ev_timeout(loop);
+  n = epoll_wait(loop->epfd, loop->events, EV_MAX_EVENTS, timeout);
+  if (n < 0) {
+    if (errno != EINTR) return -errno;
+    n = 0;
+  }
+  for (i = 0; i < n; i++) {
+    io = (struct ev_io *)loop->events[i].data.ptr;
+    io->revents |= loop->events[i].events;
+    if (list_empty(&io->node)) list_add_tail(&io->node, &loop->ready);
+  }
+
+  list_splice_init(&loop->ready, &batch);
+  while (!list_empty(&batch)) {
+    io = list_first_entry(&batch, struct ev_io, node);
+    list_del_init(&io->node);
+    revents = io->revents;
+    io->revents = 0;
+    io->cb(loop, io, revents);
+  }
+
+  __ev_run_timers(loop);
+  __ev_run_deferred(loop);
+  return n;
+}
+
+/**
+ * ev_loop_run - run until ev_loop_stop()
+ * @loop: the loop.
+ *
+ * Returns 0, or a negative errno if epoll_wait() failed.
+ */
+static int ev_loop_run(struct ev_loop *loop) {
+  int err;
+
+  loop->stop = 0;
+  while (!loop->stop) {
+    err = ev_loop_run_once(loop, 1);
+    if (err < 0) return err;
+  }
+  return 0;
+}
+
+#endif  // EV_LOOP_H_20261018
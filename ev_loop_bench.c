@@ -0,0 +1,217 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+
+#include "ev_loop.h"
+#include "perf_counters.h"
+
+/*
+ * Loopback echo throughput through one ev_loop:
+ *   ev_loop_bench [nr_conns] [seconds] [msg_size]
+ * Clients and the echo server share the loop; each connection keeps one
+ * message in flight.  A second thread ev_post()s work meanwhile, so the
+ * eventfd wakeup path is exercised under load.  Prints wall time and
+ * counters per round trip.
+ */
+
+#define MSG_MAX 4096
+
+struct conn {
+  struct ev_io io;
+  int client;
+  size_t got;
+  char buf[MSG_MAX];
+};
+
+struct poster {
+  struct ev_loop *loop;
+  struct ev_work work;
+  int done; /* set by the loop when the work item has run */
+  long posted;
+  long ran;
+};
+
+static struct ev_io listener;
+static struct conn *conns;
+static int nr_conns, nr_accepted;
+static size_t msg_size = 64;
+static long round_trips, ticks;
+static int stopping;
+
+static int set_nonblock(int fd) {
+  int one = 1;
+
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static void conn_cb(struct ev_loop *loop, struct ev_io *io, uint32_t revents) {
+  struct conn *c = container_of(io, struct conn, io);
+  ssize_t n;
+
+  if (revents & (EPOLLERR | EPOLLHUP)) {
+    ev_io_stop(loop, io);
+    return;
+  }
+  n = read(io->fd, c->buf + c->got, msg_size - c->got);
+  if (n <= 0) {
+    if (n == 0) ev_io_stop(loop, io);
+    return;
+  }
+  c->got += (size_t)n;
+  if (c->got < msg_size) return;
+  c->got = 0;
+  if (c->client) {
+    round_trips++;
+    if (stopping) return;
+  }
+  /* one message in flight, so the socket buffer always has room */
+  if (write(io->fd, c->buf, msg_size) != (ssize_t)msg_size)
+    ev_io_stop(loop, io);
+}
+
+static void accept_cb(struct ev_loop *loop, struct ev_io *io,
+                      uint32_t revents) {
+  struct conn *c;
+  int fd;
+
+  while (nr_accepted < nr_conns) {
+    fd = accept(io->fd, NULL, NULL);
+    if (fd < 0) return;
+    set_nonblock(fd);
+    c = &conns[nr_conns + nr_accepted++];
+    ev_io_init(&c->io, fd, conn_cb);
+    ev_io_start(loop, &c->io, EPOLLIN);
+  }
+}
+
+static void tick_cb(struct ev_loop *loop, struct ev_timer *timer) {
+  ticks++;
+}
+
+static void stop_cb(struct ev_loop *loop, struct ev_timer *timer) {
+  ev_loop_stop(loop);
+}
+
+static void posted_fn(struct ev_loop *loop, struct ev_work *work) {
+  struct poster *p = container_of(work, struct poster, work);
+
+  p->ran++;
+  __atomic_store_n(&p->done, 1, __ATOMIC_RELEASE);
+}
+
+static void *poster_thread(void *arg) {
+  struct poster *p = (struct poster *)arg;
+
+  while (!__atomic_load_n(&stopping, __ATOMIC_RELAXED)) {
+    if (!__atomic_load_n(&p->done, __ATOMIC_ACQUIRE)) {
+      usleep(50);
+      continue;
+    }
+    p->done = 0;
+    p->posted++;
+    ev_post(p->loop, &p->work);
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  struct ev_loop loop;
+  struct ev_timer tick, stop;
+  struct poster poster;
+  struct perf_counters pc;
+  pthread_t thread;
+  double seconds, rate;
+  int i, fd, err;
+
+  nr_conns = argc > 1 ? atoi(argv[1]) : 64;
+  seconds = argc > 2 ? atof(argv[2]) : 2;
+  if (argc > 3) msg_size = (size_t)atol(argv[3]);
+  if (nr_conns < 1) nr_conns = 1;
+  if (msg_size < 1 || msg_size > MSG_MAX) msg_size = 64;
+
+  err = ev_loop_init(&loop, 1);
+  if (err) {
+    printf("ev_loop_init: %d\n", err);
+    return 1;
+  }
+  conns = (struct conn *)calloc(2 * (size_t)nr_conns, sizeof(*conns));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+      listen(fd, nr_conns) ||
+      getsockname(fd, (struct sockaddr *)&addr, &len)) {
+    perror("listen");
+    return 1;
+  }
+  set_nonblock(fd);
+  ev_io_init(&listener, fd, accept_cb);
+  ev_io_start(&loop, &listener, EPOLLIN);
+
+  for (i = 0; i < nr_conns; i++) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+      perror("connect");
+      return 1;
+    }
+    set_nonblock(fd);
+    conns[i].client = 1;
+    ev_io_init(&conns[i].io, fd, conn_cb);
+    ev_io_start(&loop, &conns[i].io, EPOLLIN);
+    memset(conns[i].buf, 'a' + i % 26, msg_size);
+  }
+  /* let the server accept everyone before the clock starts */
+  while (nr_accepted < nr_conns) ev_loop_run_once(&loop, 1);
+
+  poster.loop = &loop;
+  poster.done = 1;
+  poster.posted = 0;
+  poster.ran = 0;
+  ev_work_init(&poster.work, posted_fn);
+  pthread_create(&thread, NULL, poster_thread, &poster);
+
+  ev_timer_init(&tick, tick_cb);
+  ev_timer_start(&loop, &tick, 10, 10);
+  ev_timer_init(&stop, stop_cb);
+  ev_timer_start(&loop, &stop, (uint64_t)(seconds * 1000), 0);
+
+  if (!perf_counters_open(&pc))
+    printf("hardware counters unavailable, wall time only\n");
+  for (i = 0; i < nr_conns; i++)
+    if (write(conns[i].io.fd, conns[i].buf, msg_size) != (ssize_t)msg_size)
+      perror("write");
+  perf_counters_start(&pc);
+  ev_loop_run(&loop);
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "echo round trip", (uint64_t)round_trips, stdout);
+  rate = round_trips / (pc.wall_ns / 1e9);
+
+  __atomic_store_n(&stopping, 1, __ATOMIC_RELAXED);
+  pthread_join(thread, NULL);
+  /* drain the replies still in flight and the last posted work */
+  for (i = 0; i < 10; i++) ev_loop_run_once(&loop, 0);
+
+  printf("%d conns, %zu-byte messages: %ld round trips, %.0f/s\n", nr_conns,
+         msg_size, round_trips, rate);
+  printf("posted %ld, ran %ld, ticks %ld\n", poster.posted, poster.ran, ticks);
+
+  ev_timer_stop(&loop, &tick);
+  for (i = 0; i < 2 * nr_conns; i++) {
+    ev_io_stop(&loop, &conns[i].io);
+    close(conns[i].io.fd);
+  }
+  ev_io_stop(&loop, &listener);
+  close(listener.fd);
+  ev_loop_destroy(&loop);
+  free(conns);
+  return poster.posted == poster.ran ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+#ifndef HLIST_FILTER_H_20261018
+#define HLIST_FILTER_H_20261018
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "list.h"
+/*
+ * Blocked counting Bloom filter in front of an hlist_head bucket array.
+ *
+ * Every key hash selects one 64-byte block, a single cache line holding
+ * 128 4-bit counters, and sets k counters inside it.  A lookup that finds
+ * any of them at zero is a definite miss and never touches the bucket
+ * array.  Counters make deletion possible; a counter that saturates at 15
+ * stays there, which can only cost false positives, never false
+ * negatives.
+ *
+ * The filter works on the same 64-bit hash the table uses to pick a
+ * bucket, and mixes it again internally so the two are not correlated.
+ * It does not own the table; callers add and delete hashes alongside
+ * hlist_add_head()/hlist_del(), or use the wrappers below.
+ */
+
+#define HLIST_FILTER_BLOCK_BYTES 64
+#define HLIST_FILTER_BLOCK_COUNTERS (HLIST_FILTER_BLOCK_BYTES * 2)
+#define HLIST_FILTER_COUNTER_MAX 15
+
+struct hlist_filter {
+  uint8_t *blocks;
+  size_t nr_blocks;
+  unsigned k;
+  size_t nr_keys;
+  size_t nr_saturated;
+};
+
+struct hlist_filter_stats {
+  size_t memory;     /* bytes used by the counters */
+  size_t nr_keys;    /* hashes currently added */
+  unsigned k;        /* counters set per key */
+  size_t saturated;  /* counters stuck at the maximum */
+  double fpr;        /* estimated false-positive rate */
+};
+
+static uint64_t __hlist_filter_mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * hlist_filter_init - allocate a filter
+ * @f: the filter to initialize.
+ * @expected: number of keys the filter is sized for.
+ * @counters_per_key: 4-bit counters per key; 10 costs 5 bytes per key and
+ *    gives about 2% false positives.
+ *
+ * Returns 0, or -ENOMEM.
+ */
+static int hlist_filter_init(struct hlist_filter *f, size_t expected,
+                             unsigned counters_per_key) {
+  void *mem;
+  size_t counters;
+
+  if (!counters_per_key) counters_per_key = 10;
+  counters = (expected ? expected : 1) * counters_per_key;
+  f->nr_blocks = (counters + HLIST_FILTER_BLOCK_COUNTERS - 1) /
+                 HLIST_FILTER_BLOCK_COUNTERS;
+  /* k = counters_per_key * ln 2, clamped */
+  f->k = (counters_per_key * 69 + 50) / 100;
+  if (f->k < 1) f->k = 1;
+  if (f->k > 8) f->k = 8;
+  f->nr_keys = 0;
+  f->nr_saturated = 0;
+  if (posix_memalign(&mem, HLIST_FILTER_BLOCK_BYTES,
+                     f->nr_blocks * HLIST_FILTER_BLOCK_BYTES))
+    return -ENOMEM;
+  f->blocks = (uint8_t *)mem;
+  memset(f->blocks, 0, f->nr_blocks * HLIST_FILTER_BLOCK_BYTES);
+  return 0;
+}
+
+/**
+ * hlist_filter_destroy - free a filter
+ * @f: the filter to destroy.
+ */
+static void hlist_filter_destroy(struct hlist_filter *f) {
+  free(f->blocks);
+  f->blocks = NULL;
+  f->nr_blocks = 0;
+}
+
+/*
+ * Block of @h, and the first probe and stride inside it.
+ */
+static uint8_t *__hlist_filter_block(const struct hlist_filter *f, uint64_t h,
+                                     unsigned *pos, unsigned *step) {
+  h = __hlist_filter_mix(h);
+  *pos = (unsigned)h;
+  *step = (unsigned)(h >> 16) | 1;
+  return f->blocks + ((h >> 32) * f->nr_blocks >> 32) *
+                         HLIST_FILTER_BLOCK_BYTES;
+}
+
+static unsigned __hlist_filter_get(const uint8_t *block, unsigned i) {
+  return (block[i / 2] >> ((i & 1) * 4)) & 0xf;
+}
+
+static void __hlist_filter_set(uint8_t *block, unsigned i, unsigned v) {
+  unsigned shift = (i & 1) * 4;
+
+  block[i / 2] = (uint8_t)((block[i / 2] & ~(0xf << shift)) | (v << shift));
+}
+
+/**
+ * hlist_filter_add - record a key hash
+ * @f: the filter.
+ * @hash: the key hash.
+ */
+static void hlist_filter_add(struct hlist_filter *f, uint64_t hash) {
+  unsigned pos, step, i, idx, c;
+  uint8_t *block = __hlist_filter_block(f, hash, &pos, &step);
+
+  for (i = 0; i < f->k; i++, pos += step) {
+    idx = pos % HLIST_FILTER_BLOCK_COUNTERS;
+    c = __hlist_filter_get(block, idx);
+    if (c == HLIST_FILTER_COUNTER_MAX) continue;
+    if (++c == HLIST_FILTER_COUNTER_MAX) f->nr_saturated++;
+    __hlist_filter_set(block, idx, c);
+  }
+  f->nr_keys++;
+}
+
+/**
+ * hlist_filter_del - forget a key hash
+ * @f: the filter.
+ * @hash: the key hash, which must have been added before.
+ */
+static void hlist_filter_del(struct hlist_filter *f, uint64_t hash) {
+  unsigned pos, step, i, idx, c;
+  uint8_t *block = __hlist_filter_block(f, hash, &pos, &step);
+
+  for (i = 0; i < f->k; i++, pos += step) {
+    idx = pos % HLIST_FILTER_BLOCK_COUNTERS;
+    c = __hlist_filter_get(block, idx);
+    if (c == 0 || c == HLIST_FILTER_COUNTER_MAX) continue;
+    __hlist_filter_set(block, idx, c - 1);
+  }
+  f->nr_keys--;
+}
+
+/**
+ * hlist_filter_may_contain - tests whether a key hash may be present
+ * @f: the filter.
+ * @hash: the key hash.
+ *
+ * Returns 0 if the key is definitely absent, 1 if the bucket has to be
+ * searched.
+ */
+static int hlist_filter_may_contain(const struct hlist_filter *f,
+                                    uint64_t hash) {
+  unsigned pos, step, i;
+  const uint8_t *block = __hlist_filter_block(f, hash, &pos, &step);
+
+  for (i = 0; i < f->k; i++, pos += step)
+    if (!__hlist_filter_get(block, pos % HLIST_FILTER_BLOCK_COUNTERS))
+      return 0;
+  return 1;
+}
+
+/**
+ * hlist_filter_add_head - add a node to its bucket and to the filter
+ * @f: the filter.
+ * @hash: the key hash of @n.
+ * @n: the node to add.
+ * @h: the bucket selected by @hash.
+ */
+static void hlist_filter_add_head(struct hlist_filter *f, uint64_t hash,
+                                  struct hlist_node *n, struct hlist_head *h) {
+  hlist_add_head(n, h);
+  hlist_filter_add(f, hash);
+}
+
+/**
+ * hlist_filter_hlist_del - delete a node from its bucket and the filter
+ * @f: the filter.
+ * @hash: the key hash of @n.
+ * @n: the node to delete.
+ */
+static void hlist_filter_hlist_del(struct hlist_filter *f, uint64_t hash,
+                                   struct hlist_node *n) {
+  hlist_del(n);
+  hlist_filter_del(f, hash);
+}
+
+/**
+ * hlist_filter_rebuild - resize the filter and refill it from a table
+ * @f: the filter.
+ * @table: the bucket array, usually just after it was resized.
+ * @size: number of buckets in @table.
+ * @counters_per_key: as for hlist_filter_init().
+ * @hash: returns the key hash of a node.
+ *
+ * The filter is sized for the number of nodes found in @table.  Saturated
+ * counters are cleared by the rebuild.  Returns 0, or -ENOMEM, in which
+ * case the old filter is kept.
+ */
+static int hlist_filter_rebuild(struct hlist_filter *f,
+                                struct hlist_head *table, size_t size,
+                                unsigned counters_per_key,
+                                uint64_t (*hash)(struct hlist_node *)) {
+  struct hlist_filter nf;
+  struct hlist_node *pos;
+  size_t i, n = 0;
+
+  for (i = 0; i < size; i++) hlist_for_each(pos, &table[i]) n++;
+  if (hlist_filter_init(&nf, n, counters_per_key)) return -ENOMEM;
+  for (i = 0; i < size; i++)
+    hlist_for_each(pos, &table[i]) hlist_filter_add(&nf, hash(pos));
+  hlist_filter_destroy(f);
+  *f = nf;
+  return 0;
+}
+
+/**
+ * hlist_filter_get_stats - report memory use and false-positive rate
+ * @f: the filter.
+ * @st: where to store the report.
+ *
+ * The false-positive rate is the mean over blocks of (occupied fraction
+ * of the block)^k, which is exact for this layout when keys spread
+ * evenly over blocks.  It scans the whole filter.
+ */
+static void hlist_filter_get_stats(const struct hlist_filter *f,
+                                   struct hlist_filter_stats *st) {
+  const uint8_t *block;
+  size_t b;
+  unsigned i, used;
+  double p, pk, sum = 0;
+
+  for (b = 0; b < f->nr_blocks; b++) {
+    block = f->blocks + b * HLIST_FILTER_BLOCK_BYTES;
+    used = 0;
+    for (i = 0; i < HLIST_FILTER_BLOCK_COUNTERS; i++)
+      used += __hlist_filter_get(block, i) != 0;
+    p = (double)used / HLIST_FILTER_BLOCK_COUNTERS;
+    for (pk = 1, i = 0; i < f->k; i++) pk *= p;
+    sum += pk;
+  }
+  st->memory = f->nr_blocks * HLIST_FILTER_BLOCK_BYTES;
+  st->nr_keys = f->nr_keys;
+  st->k = f->k;
+  st->saturated = f->nr_saturated;
+  st->fpr = f->nr_blocks ? sum / f->nr_blocks : 0;
+}
+
+#endif  // HLIST_FILTER_H_20261018
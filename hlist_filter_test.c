@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hlist_filter.h"
+
+#define NR 100000
+
+struct mystruct {
+  uint64_t key;
+  struct hlist_node node;
+};
+
+static uint64_t myhash(uint64_t key) { return key * 0x9e3779b97f4a7c15ULL; }
+
+static uint64_t nodehash(struct hlist_node *n) {
+  return myhash(hlist_entry(n, struct mystruct, node)->key);
+}
+
+static struct mystruct *lookup(struct hlist_filter *f, struct hlist_head *t,
+                               size_t size, uint64_t key, int *walked) {
+  struct mystruct *p;
+  uint64_t h = myhash(key);
+  if (!hlist_filter_may_contain(f, h)) return NULL;
+  (*walked)++;
+  hlist_for_each_entry(p, &t[h % size], struct mystruct, node) {
+    if (p->key == key) return p;
+  }
+  return NULL;
+}
+
+int main() {
+  size_t i, size = NR / 4;
+  int walked = 0, found = 0;
+  struct hlist_head *t;
+  struct hlist_filter f;
+  struct hlist_filter_stats st;
+  struct mystruct *items;
+
+  t = (struct hlist_head *)calloc(size, sizeof(*t));
+  items = (struct mystruct *)malloc(NR * sizeof(*items));
+  hlist_filter_init(&f, NR, 10);
+  for (i = 0; i < NR; i++) {
+    items[i].key = i * 2;
+    hlist_filter_add_head(&f, myhash(i * 2), &items[i].node,
+                          &t[myhash(i * 2) % size]);
+  }
+  for (i = 0; i < NR; i += 2)
+    hlist_filter_hlist_del(&f, myhash(items[i].key), &items[i].node);
+
+  for (i = 0; i < 2 * NR; i++) found += lookup(&f, t, size, i, &walked) != 0;
+  hlist_filter_get_stats(&f, &st);
+  printf("found %d walked %d keys %zu mem %zu k %u fpr %.4f\n", found, walked,
+         st.nr_keys, st.memory, st.k, st.fpr);
+
+  hlist_filter_rebuild(&f, t, size, 10, nodehash);
+  walked = found = 0;
+  for (i = 0; i < 2 * NR; i++) found += lookup(&f, t, size, i, &walked) != 0;
+  hlist_filter_get_stats(&f, &st);
+  printf("found %d walked %d keys %zu mem %zu k %u fpr %.4f\n", found, walked,
+         st.nr_keys, st.memory, st.k, st.fpr);
+
+  hlist_filter_destroy(&f);
+  free(items);
+  free(t);
+}
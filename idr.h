@@ -0,0 +1,372 @@
+#ifndef IDR_H_20261018
+#define IDR_H_20261018
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "list.h"
+/*
+ * Integer ID to pointer map on a 64-way radix tree, after the kernel's
+ * idr.
+ *
+ * Each layer holds 64 slots and a bitmap.  In a leaf, a set bit means the
+ * slot is in use; in an interior layer it means the subtree below is
+ * full.  Allocating the smallest free ID therefore follows the first
+ * clear bit on each level, which is O(height) with height at most 6 for
+ * 31-bit IDs.  Iteration walks the tree in key order.
+ *
+ * Updates are serialised by @lock.  Lookups take no lock: slots are
+ * published with release stores and read with acquire loads, and layers
+ * are only freed by idr_destroy(), so a reader never follows a pointer
+ * to freed memory.  The cost is that a tree which once held many IDs
+ * keeps its layers until destroyed.
+ */
+
+#define IDR_BITS 6
+#define IDR_SIZE (1 << IDR_BITS)
+#define IDR_MASK (IDR_SIZE - 1)
+#define IDR_MAX_LAYERS ((31 + IDR_BITS - 1) / IDR_BITS)
+#define IDR_FULL (~(uint64_t)0)
+
+struct idr_layer {
+  uint64_t bitmap;
+  int level; /* 0 for leaves */
+  void *slots[IDR_SIZE];
+};
+
+struct idr {
+  struct idr_layer *top;
+  pthread_mutex_t lock;
+  size_t nr_ids;
+  size_t nr_layers;
+};
+
+#define IDR_INIT(name) \
+  { NULL, PTHREAD_MUTEX_INITIALIZER, 0, 0 }
+#define DEFINE_IDR(name) struct idr name = IDR_INIT(name)
+
+/**
+ * idr_init - initialize an empty map
+ * @idr: the map to initialize.
+ */
+static void idr_init(struct idr *idr) {
+  idr->top = NULL;
+  pthread_mutex_init(&idr->lock, NULL);
+  idr->nr_ids = 0;
+  idr->nr_layers = 0;
+}
+
+static void __idr_free_layer(struct idr_layer *l) {
+  int i;
+
+  if (l->level)
+    for (i = 0; i < IDR_SIZE; i++)
+      if (l->slots[i]) __idr_free_layer((struct idr_layer *)l->slots[i]);
+  free(l);
+}
+
+/**
+ * idr_destroy - free all layers
+ * @idr: the map to destroy.
+ *
+ * The objects the IDs pointed to are not touched.  No lookups may be in
+ * flight.
+ */
+static void idr_destroy(struct idr *idr) {
+  if (idr->top) __idr_free_layer(idr->top);
+  idr->top = NULL;
+  idr->nr_ids = 0;
+  idr->nr_layers = 0;
+  pthread_mutex_destroy(&idr->lock);
+}
+
+/**
+ * idr_is_empty - tests whether no ID is allocated
+ * @idr: the map to test.
+ */
+static int idr_is_empty(const struct idr *idr) {
+  return __atomic_load_n(&idr->nr_ids, __ATOMIC_RELAXED) == 0;
+}
+
+/**
+ * idr_count - number of allocated IDs
+ * @idr: the map to inspect.
+ */
+static size_t idr_count(const struct idr *idr) {
+  return __atomic_load_n(&idr->nr_ids, __ATOMIC_RELAXED);
+}
+
+/**
+ * idr_memory - bytes used by the tree layers
+ * @idr: the map to inspect.
+ */
+static size_t idr_memory(const struct idr *idr) {
+  return __atomic_load_n(&idr->nr_layers, __ATOMIC_RELAXED) *
+         sizeof(struct idr_layer);
+}
+
+static struct idr_layer *__idr_new_layer(struct idr *idr, int level) {
+  struct idr_layer *l = (struct idr_layer *)calloc(1, sizeof(*l));
+
+  if (l) {
+    l->level = level;
+    idr->nr_layers++;
+  }
+  return l;
+}
+
+/* Number of IDs below a layer of @level. */
+static long __idr_span(int level) { return 1L << (IDR_BITS * (level + 1)); }
+
+/*
+ * Smallest free ID >= @start below @l, relative to @l, or -1.
+ */
+static long __idr_find_free(const struct idr_layer *l, long start) {
+  int shift = IDR_BITS * l->level;
+  int i = (int)(start >> shift);
+  long sub = start & ((1L << shift) - 1);
+  uint64_t avail;
+  const struct idr_layer *child;
+  long r;
+
+  while (i < IDR_SIZE) {
+    avail = ~l->bitmap & (IDR_FULL << i);
+    if (!avail) return -1;
+    if (__builtin_ctzll(avail) != i) sub = 0;
+    i = __builtin_ctzll(avail);
+    if (!l->level) return i;
+    child = (const struct idr_layer *)l->slots[i];
+    if (!child) return ((long)i << shift) + sub;
+    r = __idr_find_free(child, sub);
+    if (r >= 0) return ((long)i << shift) + r;
+    i++;
+    sub = 0;
+  }
+  return -1;
+}
+
+/*
+ * Store @ptr at @id, growing the tree as needed.  Called with the lock
+ * held and @id known to be free.
+ */
+static int __idr_insert(struct idr *idr, long id, void *ptr) {
+  struct idr_layer *path[IDR_MAX_LAYERS + 1];
+  struct idr_layer *l, *child;
+  int level, i;
+
+  if (!idr->top) {
+    idr->top = __idr_new_layer(idr, 0);
+    if (!idr->top) return -ENOMEM;
+  }
+  while (id >= __idr_span(idr->top->level)) {
+    l = __idr_new_layer(idr, idr->top->level + 1);
+    if (!l) return -ENOMEM;
+    l->slots[0] = idr->top;
+    if (idr->top->bitmap == IDR_FULL) l->bitmap = 1;
+    __atomic_store_n(&idr->top, l, __ATOMIC_RELEASE);
+  }
+
+  l = idr->top;
+  for (level = l->level; level > 0; level--) {
+    path[level] = l;
+    i = (int)(id >> (IDR_BITS * level)) & IDR_MASK;
+    child = (struct idr_layer *)l->slots[i];
+    if (!child) {
+      child = __idr_new_layer(idr, level - 1);
+      if (!child) return -ENOMEM;
+      __atomic_store_n(&l->slots[i], child, __ATOMIC_RELEASE);
+    }
+    l = child;
+  }
+  i = (int)id & IDR_MASK;
+  l->bitmap |= (uint64_t)1 << i;
+  __atomic_store_n(&l->slots[i], ptr, __ATOMIC_RELEASE);
+
+  /* propagate "full" upwards */
+  for (level = 1; level <= idr->top->level && l->bitmap == IDR_FULL;
+       level++) {
+    l = path[level];
+    l->bitmap |= (uint64_t)1 << ((id >> (IDR_BITS * level)) & IDR_MASK);
+  }
+  __atomic_add_fetch(&idr->nr_ids, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/**
+ * idr_alloc - allocate the smallest free ID in a range
+ * @idr: the map.
+ * @ptr: the pointer to associate with the ID, must not be NULL.
+ * @start: the minimum ID, inclusive.
+ * @end: the maximum ID, exclusive; 0 or less means INT_MAX.
+ *
+ * Returns the new ID, -ENOSPC if the range is full, -ENOMEM or -EINVAL.
+ */
+static int idr_alloc(struct idr *idr, void *ptr, int start, int end) {
+  long id;
+  int err;
+
+  if (!ptr || start < 0) return -EINVAL;
+  if (end <= 0) end = INT_MAX;
+  pthread_mutex_lock(&idr->lock);
+  if (!idr->top || start >= __idr_span(idr->top->level)) {
+    id = start;
+  } else {
+    id = __idr_find_free(idr->top, start);
+    if (id < 0) id = __idr_span(idr->top->level);
+  }
+  if (id >= end) {
+    pthread_mutex_unlock(&idr->lock);
+    return -ENOSPC;
+  }
+  err = __idr_insert(idr, id, ptr);
+  pthread_mutex_unlock(&idr->lock);
+  return err ? err : (int)id;
+}
+
+/**
+ * idr_find - look up the pointer for an ID without locking
+ * @idr: the map.
+ * @id: the ID to look up.
+ *
+ * Returns the pointer, or NULL if @id is not allocated.
+ */
+static void *idr_find(const struct idr *idr, int id) {
+  const struct idr_layer *l = __atomic_load_n(&idr->top, __ATOMIC_ACQUIRE);
+  int level;
+
+  if (!l || id < 0 || id >= __idr_span(l->level)) return NULL;
+  for (level = l->level; l && level > 0; level--)
+    l = (const struct idr_layer *)__atomic_load_n(
+        &l->slots[(id >> (IDR_BITS * level)) & IDR_MASK], __ATOMIC_ACQUIRE);
+  if (!l) return NULL;
+  return __atomic_load_n(&l->slots[id & IDR_MASK], __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Leaf holding @id and the path to it, or NULL.  Lock held.
+ */
+static struct idr_layer *__idr_leaf(struct idr *idr, int id,
+                                    struct idr_layer **path) {
+  struct idr_layer *l = idr->top;
+  int level;
+
+  if (!l || id < 0 || id >= __idr_span(l->level)) return NULL;
+  for (level = l->level; l && level > 0; level--) {
+    path[level] = l;
+    l = (struct idr_layer *)l->slots[(id >> (IDR_BITS * level)) & IDR_MASK];
+  }
+  return l;
+}
+
+/**
+ * idr_remove - free an ID
+ * @idr: the map.
+ * @id: the ID to free.
+ *
+ * Returns the pointer that was associated with @id, or NULL.  Lock-free
+ * readers may still see the old pointer until they finish, so the object
+ * must not be freed before they are known to be done.
+ */
+static void *idr_remove(struct idr *idr, int id) {
+  struct idr_layer *path[IDR_MAX_LAYERS + 1];
+  struct idr_layer *l;
+  void *ptr = NULL;
+  int level, i;
+
+  pthread_mutex_lock(&idr->lock);
+  l = __idr_leaf(idr, id, path);
+  i = id & IDR_MASK;
+  if (l && l->slots[i]) {
+    ptr = l->slots[i];
+    __atomic_store_n(&l->slots[i], (void *)NULL, __ATOMIC_RELEASE);
+    l->bitmap &= ~((uint64_t)1 << i);
+    for (level = 1; level <= idr->top->level; level++)
+      path[level]->bitmap &=
+          ~((uint64_t)1 << ((id >> (IDR_BITS * level)) & IDR_MASK));
+    __atomic_sub_fetch(&idr->nr_ids, 1, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&idr->lock);
+  return ptr;
+}
+
+/**
+ * idr_replace - change the pointer of an allocated ID
+ * @idr: the map.
+ * @ptr: the new pointer, must not be NULL.
+ * @id: the ID.
+ *
+ * Returns the old pointer, or NULL if @id is not allocated.
+ */
+static void *idr_replace(struct idr *idr, void *ptr, int id) {
+  struct idr_layer *path[IDR_MAX_LAYERS + 1];
+  struct idr_layer *l;
+  void *old = NULL;
+
+  if (!ptr) return NULL;
+  pthread_mutex_lock(&idr->lock);
+  l = __idr_leaf(idr, id, path);
+  if (l && l->slots[id & IDR_MASK]) {
+    old = l->slots[id & IDR_MASK];
+    __atomic_store_n(&l->slots[id & IDR_MASK], ptr, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&idr->lock);
+  return old;
+}
+
+/*
+ * First allocated ID >= @start below @l, relative to @l, or -1.
+ */
+static long __idr_next(const struct idr_layer *l, long start, void **ptr) {
+  int shift = IDR_BITS * l->level;
+  int i = (int)(start >> shift);
+  long sub = start & ((1L << shift) - 1);
+  const void *slot;
+  long r;
+
+  for (; i < IDR_SIZE; i++, sub = 0) {
+    slot = __atomic_load_n(&l->slots[i], __ATOMIC_ACQUIRE);
+    if (!slot) continue;
+    if (!l->level) {
+      *ptr = (void *)slot;
+      return i;
+    }
+    r = __idr_next((const struct idr_layer *)slot, sub, ptr);
+    if (r >= 0) return ((long)i << shift) + r;
+  }
+  return -1;
+}
+
+/**
+ * idr_get_next - find the next allocated ID
+ * @idr: the map.
+ * @nextid: the ID to start from; updated to the ID found.
+ *
+ * Returns the pointer for the smallest allocated ID >= *@nextid, or NULL
+ * if there is none.  Takes no lock.
+ */
+static void *idr_get_next(const struct idr *idr, int *nextid) {
+  const struct idr_layer *l = __atomic_load_n(&idr->top, __ATOMIC_ACQUIRE);
+  void *ptr = NULL;
+  long id;
+
+  if (!l || *nextid < 0 || *nextid >= __idr_span(l->level)) return NULL;
+  id = __idr_next(l, *nextid, &ptr);
+  if (id < 0) return NULL;
+  *nextid = (int)id;
+  return ptr;
+}
+
+/**
+ * idr_for_each_entry - iterate over allocated IDs in increasing order
+ * @idr:    the map.
+ * @entry:    the type * to use as a loop cursor.
+ * @id:    int to use as the ID cursor.
+ * @type:    the type of the objects stored in the map.
+ */
+#define idr_for_each_entry(idr, entry, id, type)                         \
+  for (id = 0; ((entry) = (type *)idr_get_next(idr, &(id))) != NULL; \
+       id++)
+
+#endif  // IDR_H_20261018
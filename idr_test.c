@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "idr.h"
+
+#define NR 1000000
+
+struct conn {
+  int id;
+  struct list_head list;
+};
+
+int main() {
+  int i, id, bad = 0;
+  DEFINE_IDR(idr);
+  struct conn *c, *conns;
+  struct list_head all = LIST_HEAD_INIT(all);
+
+  conns = (struct conn *)malloc(NR * sizeof(*conns));
+  for (i = 0; i < NR; i++) {
+    conns[i].id = idr_alloc(&idr, &conns[i], 0, 0);
+    if (conns[i].id != i) bad++;
+    list_add_tail(&conns[i].list, &all);
+  }
+  printf("ids %zu memory %zu bytes (%.1f per id) bad %d\n", idr_count(&idr),
+         idr_memory(&idr), (double)idr_memory(&idr) / idr_count(&idr), bad);
+
+  for (i = 0; i < NR; i += 3) {
+    if (idr_remove(&idr, i) != &conns[i]) bad++;
+    list_del_init(&conns[i].list);
+  }
+  for (i = 0; i < NR; i++)
+    if ((idr_find(&idr, i) != NULL) != (i % 3 != 0)) bad++;
+
+  /* the smallest free IDs are handed out again first */
+  printf("realloc %d,", idr_alloc(&idr, &conns[0], 0, 0));
+  printf("%d,", idr_alloc(&idr, &conns[3], 0, 0));
+  printf("%d\n", idr_alloc(&idr, &conns[6], 10, 0));
+  printf("range full %d\n", idr_alloc(&idr, &conns[9], 1, 3));
+
+  i = 0;
+  idr_for_each_entry(&idr, c, id, struct conn) {
+    if (id >= 9 && id < 16) printf("%d->%d,", id, c->id);
+    i++;
+  }
+  printf("\niterated %d count %zu bad %d\n", i, idr_count(&idr), bad);
+  printf("past end %p\n", idr_find(&idr, INT_MAX));
+  idr_destroy(&idr);
+  free(conns);
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_sort.h"
+#include "perf_counters.h"
+
+/*
+ * List workloads under hardware counters:
+ *   list_bench [nr_nodes]
+ * Prints wall time and counters per node visited.
+ */
+
+struct mystruct {
+  long a;
+  struct list_head list;
+};
+
+static int mycmp(void *priv, struct list_head *a, struct list_head *b) {
+  struct mystruct *pa = list_entry(a, struct mystruct, list);
+  struct mystruct *pb = list_entry(b, struct mystruct, list);
+  return pa->a > pb->a;
+}
+
+int main(int argc, char **argv) {
+  long i, j, nr = argc > 1 ? atol(argv[1]) : 1000000, sum = 0;
+  struct list_head head = LIST_HEAD_INIT(head);
+  struct list_head tmp = LIST_HEAD_INIT(tmp);
+  struct list_head *pos;
+  struct mystruct *items, **order, *p, *t;
+  struct perf_counters pc;
+
+  if (nr < 2) nr = 2;
+  if (!perf_counters_open(&pc))
+    printf("hardware counters unavailable, wall time only\n");
+
+  /* link nodes in random memory order, like a long-lived list */
+  items = (struct mystruct *)malloc(nr * sizeof(*items));
+  order = (struct mystruct **)malloc(nr * sizeof(*order));
+  srand(1);
+  for (i = 0; i < nr; i++) order[i] = &items[i];
+  for (i = nr - 1; i > 0; i--) {
+    j = rand() % (i + 1);
+    p = order[i];
+    order[i] = order[j];
+    order[j] = p;
+  }
+  for (i = 0; i < nr; i++) {
+    order[i]->a = rand();
+    list_add_tail(&order[i]->list, &head);
+  }
+
+  perf_counters_start(&pc);
+  list_for_each_entry(p, &head, struct mystruct, list) sum += p->a;
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "traverse", nr, stdout);
+
+  perf_counters_start(&pc);
+  list_for_each_entry_reverse(p, &head, struct mystruct, list) sum -= p->a;
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "traverse-reverse", nr, stdout);
+
+  /* cut the first half off and splice it back at the tail, repeatedly */
+  pos = &head;
+  for (i = 0; i < nr / 2; i++) pos = pos->next;
+  perf_counters_start(&pc);
+  for (i = 0; i < 1000; i++) {
+    list_cut_position(&tmp, &head, pos);
+    pos = head.prev; /* end of the other half, the next cut point */
+    list_splice_tail_init(&tmp, &head);
+  }
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "cut+splice", 1000, stdout);
+
+  perf_counters_start(&pc);
+  list_sort(NULL, &head, mycmp);
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "sort", nr, stdout);
+
+  perf_counters_start(&pc);
+  list_for_each_entry(p, &head, struct mystruct, list) sum += p->a;
+  perf_counters_stop(&pc);
+  perf_counters_report(&pc, "traverse-sorted", nr, stdout);
+
+  i = 0;
+  list_for_each_entry_safe(p, t, &head, struct mystruct, list) {
+    if (&t->list != &head && t->a < p->a) i++;
+  }
+  printf("unsorted pairs %ld checksum %ld\n", i, sum);
+
+  perf_counters_close(&pc);
+  free(order);
+  free(items);
+}
@@ -0,0 +1,193 @@
+#ifndef LIST_CURSOR_H_20261018
+#define LIST_CURSOR_H_20261018
+#include <errno.h>
+
+#include "list.h"
+/*
+ * Resumable cursor iteration over a list_head.
+ *
+ * A cursor plants a marker list_head in the list right after the last
+ * entry it returned.  The walker may drop the list lock at any point
+ * between two list_cursor_next() calls: whatever happens to the
+ * neighbours meanwhile, the marker stays linked and the walk resumes
+ * from it.  Entries added behind the marker are not visited; entries
+ * added after it are.
+ *
+ * Markers are taken from a small array inside struct clist_head, so a
+ * marker is recognised by its address and entries need no extra field.
+ * Anything that walks a clist while cursors may be active must use the
+ * clist_* iterators, which skip markers.  All functions here must be
+ * called with the list lock held.
+ */
+
+#ifndef LIST_CURSOR_MAX
+#define LIST_CURSOR_MAX 8
+#endif
+#if LIST_CURSOR_MAX < 1 || LIST_CURSOR_MAX > 32
+#error "LIST_CURSOR_MAX must be 1..32, the busy bitmap is an unsigned"
+#endif
+
+struct clist_head {
+  struct list_head head;
+  unsigned busy; /* bitmap of markers in use */
+  struct list_head markers[LIST_CURSOR_MAX];
+};
+
+struct list_cursor {
+  struct clist_head *ch;
+  struct list_head *marker;
+  unsigned batch;
+  unsigned count;
+};
+
+/**
+ * clist_init - initialize a cursor-capable list
+ * @ch: the list to initialize.
+ */
+static void clist_init(struct clist_head *ch) {
+  int i;
+
+  INIT_LIST_HEAD(&ch->head);
+  ch->busy = 0;
+  for (i = 0; i < LIST_CURSOR_MAX; i++) INIT_LIST_HEAD(&ch->markers[i]);
+}
+
+/**
+ * clist_is_marker - tests whether @pos is a cursor marker of @ch
+ * @pos: the list_head to test.
+ * @ch: the list @pos is on.
+ */
+static int clist_is_marker(const struct list_head *pos,
+                           const struct clist_head *ch) {
+  return pos >= &ch->markers[0] && pos < &ch->markers[LIST_CURSOR_MAX];
+}
+
+/*
+ * Return @pos, or the first non-marker entry after it, or the head.
+ */
+static struct list_head *__clist_skip(struct list_head *pos,
+                                      struct clist_head *ch) {
+  while (pos != &ch->head && clist_is_marker(pos, ch)) pos = pos->next;
+  return pos;
+}
+
+/**
+ * clist_empty - tests whether a list has no entries besides markers
+ * @ch: the list to test.
+ */
+static int clist_empty(struct clist_head *ch) {
+  return __clist_skip(ch->head.next, ch) == &ch->head;
+}
+
+/**
+ * list_cursor_start - begin a resumable walk
+ * @cur: the cursor to start.
+ * @ch: the list to walk.
+ * @batch: list_cursor_need_yield() turns true every @batch entries;
+ *    0 means never.
+ *
+ * Returns 0, or -EBUSY if LIST_CURSOR_MAX walks are already active.
+ */
+static int list_cursor_start(struct list_cursor *cur, struct clist_head *ch,
+                             unsigned batch) {
+  int i;
+
+  for (i = 0; i < LIST_CURSOR_MAX; i++)
+    if (!(ch->busy & (1u << i))) break;
+  if (i == LIST_CURSOR_MAX) return -EBUSY;
+  ch->busy |= 1u << i;
+  cur->ch = ch;
+  cur->marker = &ch->markers[i];
+  cur->batch = batch;
+  cur->count = 0;
+  list_add(cur->marker, &ch->head);
+  return 0;
+}
+
+/**
+ * list_cursor_next - return the next entry and move the marker past it
+ * @cur: the cursor.
+ *
+ * The returned entry is only guaranteed to exist until the lock is
+ * dropped.  It may be deleted by the walker before that.  Returns NULL
+ * at the end of the list.
+ */
+static struct list_head *list_cursor_next(struct list_cursor *cur) {
+  struct list_head *pos = __clist_skip(cur->marker->next, cur->ch);
+
+  if (pos == &cur->ch->head) return NULL;
+  list_move(cur->marker, pos);
+  cur->count++;
+  return pos;
+}
+
+/**
+ * list_cursor_need_yield - tests whether the walker should drop the lock
+ * @cur: the cursor.
+ *
+ * True once every @batch entries returned by list_cursor_next().
+ */
+static int list_cursor_need_yield(const struct list_cursor *cur) {
+  return cur->batch && cur->count && cur->count % cur->batch == 0;
+}
+
+/**
+ * list_cursor_end - finish a walk and unlink the marker
+ * @cur: the cursor.
+ *
+ * May be called before the end of the list is reached.
+ */
+static void list_cursor_end(struct list_cursor *cur) {
+  list_del_init(cur->marker);
+  cur->ch->busy &= ~(1u << (cur->marker - cur->ch->markers));
+  cur->marker = NULL;
+}
+
+/**
+ * list_cursor_entry - get the struct for the entry returned by a cursor
+ * @ptr:    the &struct list_head pointer, may be NULL.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the list_head within the struct.
+ */
+#define list_cursor_entry(ptr, type, member)                             \
+  ({                                                                     \
+    struct list_head *ptr__ = (ptr);                                     \
+    ptr__ ? list_entry(ptr__, type, member) : (type *)NULL;              \
+  })
+
+/**
+ * list_cursor_for_each_entry - walk a clist through a cursor
+ * @pos:    the type * to use as a loop cursor.
+ * @cur:    a started &struct list_cursor.
+ * @member:    the name of the list_head within the struct.
+ *
+ * The loop body may delete @pos and may drop and retake the list lock.
+ */
+#define list_cursor_for_each_entry(pos, cur, type, member) \
+  while ((pos = list_cursor_entry(list_cursor_next(cur), type, member)))
+
+/**
+ * clist_for_each_entry    -    iterate over a clist, skipping markers
+ * @pos:    the type * to use as a loop cursor.
+ * @ch:    the &struct clist_head.
+ * @member:    the name of the list_head within the struct.
+ */
+#define clist_for_each_entry(pos, ch, type, member)                          \
+  for (pos = list_entry(__clist_skip((ch)->head.next, ch), type, member);    \
+       &pos->member != &(ch)->head;                                          \
+       pos = list_entry(__clist_skip(pos->member.next, ch), type, member))
+
+/**
+ * clist_for_each_entry_safe - iterate over a clist safe against removal
+ * @pos:    the type * to use as a loop cursor.
+ * @n:        another type * to use as temporary storage
+ * @ch:    the &struct clist_head.
+ * @member:    the name of the list_head within the struct.
+ */
+#define clist_for_each_entry_safe(pos, n, ch, type, member)                  \
+  for (pos = list_entry(__clist_skip((ch)->head.next, ch), type, member),    \
+      n = list_entry(__clist_skip(pos->member.next, ch), type, member);      \
+       &pos->member != &(ch)->head;                                          \
+       pos = n, n = list_entry(__clist_skip(n->member.next, ch), type, member))
+
+#endif  // LIST_CURSOR_H_20261018
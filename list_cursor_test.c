@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_cursor.h"
+
+#define NR 1000
+
+struct mystruct {
+  int a;
+  int seen;
+  struct list_head list;
+};
+
+int main() {
+  int i, yields = 0, dropped = 0, missed = 0, twice = 0;
+  struct clist_head ch;
+  struct list_cursor cur, other;
+  struct mystruct *p, *t, *items[NR];
+
+  clist_init(&ch);
+  for (i = 0; i < NR; i++) {
+    p = (struct mystruct *)malloc(sizeof(struct mystruct));
+    p->a = i;
+    p->seen = 0;
+    items[i] = p;
+    list_add_tail(&p->list, &ch.head);
+  }
+
+  /* a second, idle walk leaves its marker at the front */
+  list_cursor_start(&other, &ch, 0);
+
+  list_cursor_start(&cur, &ch, 16);
+  list_cursor_for_each_entry(p, &cur, struct mystruct, list) {
+    p->seen++;
+    if (list_cursor_need_yield(&cur)) {
+      /* "lock dropped": someone deletes both neighbours of the marker */
+      yields++;
+      list_del(&p->list);
+      items[p->a] = NULL;
+      free(p);
+      if (!list_is_last(cur.marker, &ch.head)) {
+        t = list_entry(cur.marker->next, struct mystruct, list);
+        list_del(&t->list);
+        items[t->a] = NULL;
+        free(t);
+      }
+      dropped += 2;
+    }
+  }
+  list_cursor_end(&cur);
+  list_cursor_end(&other);
+
+  for (i = 0; i < NR; i++) {
+    if (!items[i]) continue;
+    if (items[i]->seen == 0) missed++;
+    if (items[i]->seen > 1) twice++;
+  }
+  i = 0;
+  clist_for_each_entry(p, &ch, struct mystruct, list) i++;
+  printf("yields %d dropped %d left %d missed %d twice %d\n", yields, dropped,
+         i, missed, twice);
+
+  clist_for_each_entry_safe(p, t, &ch, struct mystruct, list) free(p);
+}
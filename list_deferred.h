@@ -0,0 +1,401 @@
+#ifndef LIST_DEFERRED_H_20261018
+#define LIST_DEFERRED_H_20261018
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "list.h"
+/*
+ * Deferred (tombstone) deletion on top of list_head.
+ *
+ * Readers walk the list under the shared side of @lock.  Removing an
+ * entry with dlist_del_deferred() only marks it dead, so it can be done
+ * from a reader without upgrading to the exclusive lock.  The iteration
+ * macros below skip dead entries.  dlist_reclaim() later takes the
+ * exclusive lock once, cuts every run of adjacent dead entries out with a
+ * single list_bulk_move_tail() and hands them to @release after the lock
+ * has been dropped.  Reclaim is triggered when the number of dead entries
+ * reaches @threshold, either by the caller or by a background thread
+ * started with dlist_start_reclaimer().
+ */
+
+struct dlist_node {
+  struct list_head list;
+  int dead;
+};
+
+struct dlist_stats {
+  size_t live;      /* entries not marked dead */
+  size_t dead;      /* tombstones still linked */
+  size_t reclaimed; /* entries handed to release so far */
+  size_t runs;      /* bulk unlinks performed so far */
+  size_t passes;    /* reclaim passes performed so far */
+};
+
+struct dlist_head {
+  struct list_head head;
+  pthread_rwlock_t lock;
+  size_t nr_live;
+  size_t nr_dead;
+  size_t threshold;
+  size_t nr_reclaimed;
+  size_t nr_runs;
+  size_t nr_passes;
+  void (*release)(struct dlist_node *node);
+
+  /* background reclaimer */
+  pthread_mutex_t kick_lock;
+  pthread_cond_t kick_cond;
+  pthread_t reclaimer;
+  int kick;
+  int running;
+  int stop;
+  unsigned interval_ms;
+};
+
+/**
+ * dlist_init - initialize a deferred-delete list
+ * @dh: the list to initialize.
+ * @threshold: number of dead entries that triggers a reclaim, 0 means 1.
+ * @release: called on every reclaimed entry, outside the lock; may be NULL.
+ */
+static void dlist_init(struct dlist_head *dh, size_t threshold,
+                       void (*release)(struct dlist_node *)) {
+  pthread_condattr_t attr;
+
+  INIT_LIST_HEAD(&dh->head);
+  pthread_rwlock_init(&dh->lock, NULL);
+  dh->nr_live = 0;
+  dh->nr_dead = 0;
+  dh->threshold = threshold ? threshold : 1;
+  dh->nr_reclaimed = 0;
+  dh->nr_runs = 0;
+  dh->nr_passes = 0;
+  dh->release = release;
+  pthread_mutex_init(&dh->kick_lock, NULL);
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&dh->kick_cond, &attr);
+  pthread_condattr_destroy(&attr);
+  dh->kick = 0;
+  dh->running = 0;
+  dh->stop = 0;
+  dh->interval_ms = 0;
+}
+
+static void dlist_read_lock(struct dlist_head *dh) {
+  pthread_rwlock_rdlock(&dh->lock);
+}
+
+static void dlist_read_unlock(struct dlist_head *dh) {
+  pthread_rwlock_unlock(&dh->lock);
+}
+
+static void dlist_write_lock(struct dlist_head *dh) {
+  pthread_rwlock_wrlock(&dh->lock);
+}
+
+static void dlist_write_unlock(struct dlist_head *dh) {
+  pthread_rwlock_unlock(&dh->lock);
+}
+
+/**
+ * dlist_node_dead - tests whether @node has been deleted
+ * @node: the entry to test
+ */
+static int dlist_node_dead(const struct dlist_node *node) {
+  return __atomic_load_n(&node->dead, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * dlist_add_tail - add a live entry at the tail
+ * @node: new_node entry to be added
+ * @dh: the list to add it to
+ *
+ * Caller must hold the write lock.
+ */
+static void dlist_add_tail(struct dlist_node *node, struct dlist_head *dh) {
+  node->dead = 0;
+  list_add_tail(&node->list, &dh->head);
+  __atomic_add_fetch(&dh->nr_live, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * dlist_add - add a live entry at the head
+ * @node: new_node entry to be added
+ * @dh: the list to add it to
+ *
+ * Caller must hold the write lock.
+ */
+static void dlist_add(struct dlist_node *node, struct dlist_head *dh) {
+  node->dead = 0;
+  list_add(&node->list, &dh->head);
+  __atomic_add_fetch(&dh->nr_live, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * dlist_del_deferred - mark an entry dead without unlinking it
+ * @node: the entry to delete
+ * @dh: the list @node is on
+ *
+ * May be called with only the read lock held.  Marking an entry twice is
+ * harmless.  Returns 1 if the tombstone count is at or above the
+ * threshold and no background reclaimer is running, meaning the caller
+ * should call dlist_reclaim() once it has dropped its lock; 0 otherwise.
+ * Every delete past the threshold reports it again, so a caller that
+ * cannot act on it right away does not lose the signal.
+ */
+static int dlist_del_deferred(struct dlist_node *node, struct dlist_head *dh) {
+  size_t dead;
+
+  if (__atomic_exchange_n(&node->dead, 1, __ATOMIC_ACQ_REL)) return 0;
+  __atomic_sub_fetch(&dh->nr_live, 1, __ATOMIC_RELAXED);
+  dead = __atomic_add_fetch(&dh->nr_dead, 1, __ATOMIC_RELAXED);
+  if (dead < dh->threshold) return 0;
+
+  if (!__atomic_load_n(&dh->running, __ATOMIC_ACQUIRE)) return 1;
+  pthread_mutex_lock(&dh->kick_lock);
+  if (!dh->kick) {
+    dh->kick = 1;
+    pthread_cond_signal(&dh->kick_cond);
+  }
+  pthread_mutex_unlock(&dh->kick_lock);
+  return 0;
+}
+
+/**
+ * dlist_need_reclaim - tests whether the tombstone threshold is reached
+ * @dh: the list to test
+ */
+static int dlist_need_reclaim(const struct dlist_head *dh) {
+  return __atomic_load_n(&dh->nr_dead, __ATOMIC_RELAXED) >= dh->threshold;
+}
+
+/**
+ * dlist_tombstone_ratio - fraction of linked entries that are dead
+ * @dh: the list to inspect
+ *
+ * Returns a value in [0, 1], 0 for an empty list.  Intended for tuning
+ * the threshold, the counters are read without the lock.
+ */
+static double dlist_tombstone_ratio(const struct dlist_head *dh) {
+  size_t live = __atomic_load_n(&dh->nr_live, __ATOMIC_RELAXED);
+  size_t dead = __atomic_load_n(&dh->nr_dead, __ATOMIC_RELAXED);
+
+  if (live + dead == 0) return 0;
+  return (double)dead / (double)(live + dead);
+}
+
+/**
+ * dlist_get_stats - snapshot the list counters
+ * @dh: the list to inspect
+ * @st: where to store the snapshot
+ */
+static void dlist_get_stats(const struct dlist_head *dh,
+                            struct dlist_stats *st) {
+  st->live = __atomic_load_n(&dh->nr_live, __ATOMIC_RELAXED);
+  st->dead = __atomic_load_n(&dh->nr_dead, __ATOMIC_RELAXED);
+  st->reclaimed = __atomic_load_n(&dh->nr_reclaimed, __ATOMIC_RELAXED);
+  st->runs = __atomic_load_n(&dh->nr_runs, __ATOMIC_RELAXED);
+  st->passes = __atomic_load_n(&dh->nr_passes, __ATOMIC_RELAXED);
+}
+
+/*
+ * Move every dead entry of @dh to @reap.  Adjacent dead entries are
+ * moved as one run.  Caller must hold the write lock.
+ */
+static size_t __dlist_collect(struct dlist_head *dh, struct list_head *reap) {
+  struct list_head *pos = dh->head.next;
+  struct list_head *first, *last;
+  size_t n = 0, runs = 0;
+
+  while (pos != &dh->head) {
+    if (!container_of(pos, struct dlist_node, list)->dead) {
+      pos = pos->next;
+      continue;
+    }
+    first = last = pos;
+    n++;
+    while (last->next != &dh->head &&
+           container_of(last->next, struct dlist_node, list)->dead) {
+      last = last->next;
+      n++;
+    }
+    pos = last->next;
+    list_bulk_move_tail(reap, first, last);
+    runs++;
+  }
+  __atomic_sub_fetch(&dh->nr_dead, n, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&dh->nr_reclaimed, n, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&dh->nr_runs, runs, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&dh->nr_passes, 1, __ATOMIC_RELAXED);
+  return n;
+}
+
+/*
+ * Reclaim if at least @min entries are dead, checked under the write
+ * lock so that callers racing on the same signal do one pass between
+ * them.
+ */
+static size_t __dlist_reclaim(struct dlist_head *dh, size_t min) {
+  struct list_head reap = LIST_HEAD_INIT(reap);
+  struct list_head *pos, *n;
+  size_t nr = 0;
+
+  dlist_write_lock(dh);
+  if (__atomic_load_n(&dh->nr_dead, __ATOMIC_RELAXED) >= min)
+    nr = __dlist_collect(dh, &reap);
+  dlist_write_unlock(dh);
+
+  list_for_each_safe(pos, n, &reap) {
+    list_del_init(pos);
+    if (dh->release) dh->release(container_of(pos, struct dlist_node, list));
+  }
+  return nr;
+}
+
+/**
+ * dlist_reclaim - unlink and release all dead entries
+ * @dh: the list to reclaim
+ *
+ * Takes the write lock for the unlinking pass only; @release runs after
+ * it has been dropped.  Must not be called with the lock held.  Returns
+ * at once if the tombstone count is already below the threshold, e.g.
+ * because another caller reclaimed first.  Returns the number of entries
+ * reclaimed.
+ */
+static size_t dlist_reclaim(struct dlist_head *dh) {
+  return __dlist_reclaim(dh, dh->threshold);
+}
+
+static void *__dlist_reclaimer(void *arg) {
+  struct dlist_head *dh = (struct dlist_head *)arg;
+  struct timespec ts;
+
+  pthread_mutex_lock(&dh->kick_lock);
+  while (!dh->stop) {
+    if (!dh->kick) {
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      ts.tv_sec += dh->interval_ms / 1000;
+      ts.tv_nsec += (long)(dh->interval_ms % 1000) * 1000000;
+      if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+      }
+      pthread_cond_timedwait(&dh->kick_cond, &dh->kick_lock, &ts);
+      if (dh->stop) break;
+    }
+    dh->kick = 0;
+    pthread_mutex_unlock(&dh->kick_lock);
+    if (dlist_need_reclaim(dh)) dlist_reclaim(dh);
+    pthread_mutex_lock(&dh->kick_lock);
+  }
+  pthread_mutex_unlock(&dh->kick_lock);
+  return NULL;
+}
+
+/**
+ * dlist_start_reclaimer - reclaim from a background thread
+ * @dh: the list to reclaim
+ * @interval_ms: how often to re-check the threshold when not woken,
+ *    measured against CLOCK_MONOTONIC
+ *
+ * The thread is woken as soon as the threshold is reached, and also polls
+ * every @interval_ms in case a wakeup raced with a previous pass.
+ * Returns 0 on success or a negative errno.
+ */
+static int dlist_start_reclaimer(struct dlist_head *dh, unsigned interval_ms) {
+  int err;
+
+  if (dh->running) return -EBUSY;
+  dh->interval_ms = interval_ms ? interval_ms : 1;
+  dh->stop = 0;
+  dh->kick = 0;
+  err = pthread_create(&dh->reclaimer, NULL, __dlist_reclaimer, dh);
+  if (err) return -err;
+  __atomic_store_n(&dh->running, 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+ * dlist_stop_reclaimer - stop the background thread
+ * @dh: the list whose reclaimer to stop
+ *
+ * Dead entries still linked stay on the list until the next
+ * dlist_reclaim().
+ */
+static void dlist_stop_reclaimer(struct dlist_head *dh) {
+  if (!dh->running) return;
+  pthread_mutex_lock(&dh->kick_lock);
+  dh->stop = 1;
+  pthread_cond_signal(&dh->kick_cond);
+  pthread_mutex_unlock(&dh->kick_lock);
+  pthread_join(dh->reclaimer, NULL);
+  __atomic_store_n(&dh->running, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * dlist_destroy - tear down a deferred-delete list
+ * @dh: the list to destroy
+ *
+ * Stops the reclaimer and reclaims remaining dead entries.  Live entries
+ * are left linked on @dh->head for the caller to free.
+ */
+static void dlist_destroy(struct dlist_head *dh) {
+  dlist_stop_reclaimer(dh);
+  __dlist_reclaim(dh, 1);
+  pthread_cond_destroy(&dh->kick_cond);
+  pthread_mutex_destroy(&dh->kick_lock);
+  pthread_rwlock_destroy(&dh->lock);
+}
+
+/*
+ * Return @pos, or the first live entry after it, or @head.
+ */
+static struct list_head *__dlist_live(struct list_head *pos,
+                                      struct list_head *head) {
+  while (pos != head && dlist_node_dead(container_of(pos, struct dlist_node,
+                                                     list)))
+    pos = pos->next;
+  return pos;
+}
+
+/**
+ * dlist_first_entry_or_null - get the first live element from a list
+ * @dh:    the dlist_head to take the element from.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the dlist_node within the struct.
+ */
+#define dlist_first_entry_or_null(dh, type, member)                     \
+  ({                                                                    \
+    struct list_head *pos__ = __dlist_live((dh)->head.next, &(dh)->head); \
+    pos__ != &(dh)->head ? list_entry(pos__, type, member.list) : NULL; \
+  })
+
+/**
+ * dlist_for_each_entry    -    iterate over the live entries of a list
+ * @pos:    the type * to use as a loop cursor.
+ * @dh:    the dlist_head for your list.
+ * @member:    the name of the dlist_node within the struct.
+ */
+#define dlist_for_each_entry(pos, dh, type, member)                        \
+  for (pos = list_entry(__dlist_live((dh)->head.next, &(dh)->head), type,  \
+                        member.list);                                      \
+       &pos->member.list != &(dh)->head;                                   \
+       pos = list_entry(__dlist_live(pos->member.list.next, &(dh)->head), \
+                        type, member.list))
+
+/**
+ * dlist_for_each_entry_continue - continue iteration over live entries
+ * @pos:    the type * to use as a loop cursor.
+ * @dh:    the dlist_head for your list.
+ * @member:    the name of the dlist_node within the struct.
+ */
+#define dlist_for_each_entry_continue(pos, dh, type, member)               \
+  for (pos = list_entry(__dlist_live(pos->member.list.next, &(dh)->head),  \
+                        type, member.list);                                \
+       &pos->member.list != &(dh)->head;                                   \
+       pos = list_entry(__dlist_live(pos->member.list.next, &(dh)->head), \
+                        type, member.list))
+
+#endif  // LIST_DEFERRED_H_20261018
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "list_deferred.h"
+
+struct mystruct {
+  int a;
+  struct dlist_node node;
+};
+
+static void myrelease(struct dlist_node *node) {
+  free(list_entry(node, struct mystruct, node));
+}
+
+int main() {
+  int i = 0;
+  struct dlist_head dh;
+  struct dlist_stats st;
+  struct mystruct *p;
+
+  dlist_init(&dh, 4, myrelease);
+  dlist_write_lock(&dh);
+  for (i = 0; i < 10; i++) {
+    p = (struct mystruct *)malloc(sizeof(struct mystruct));
+    p->a = i;
+    dlist_add_tail(&p->node, &dh);
+  }
+  dlist_write_unlock(&dh);
+
+  int reclaim = 0;
+  dlist_read_lock(&dh);
+  dlist_for_each_entry(p, &dh, struct mystruct, node) {
+    if (p->a >= 2 && p->a <= 4) reclaim |= dlist_del_deferred(&p->node, &dh);
+    if (p->a == 7) reclaim |= dlist_del_deferred(&p->node, &dh);
+  }
+  dlist_for_each_entry(p, &dh, struct mystruct, node) printf("%d,", p->a);
+  printf("\n");
+  dlist_read_unlock(&dh);
+
+  printf("ratio %.2f reclaim %d\n", dlist_tombstone_ratio(&dh), reclaim);
+  if (reclaim) dlist_reclaim(&dh);
+  dlist_get_stats(&dh, &st);
+  printf("live %zu dead %zu reclaimed %zu runs %zu\n", st.live, st.dead,
+         st.reclaimed, st.runs);
+
+  dlist_start_reclaimer(&dh, 10);
+  dlist_read_lock(&dh);
+  dlist_for_each_entry(p, &dh, struct mystruct, node) {
+    if (p->a != 0) dlist_del_deferred(&p->node, &dh);
+  }
+  dlist_read_unlock(&dh);
+  usleep(50 * 1000);
+  dlist_get_stats(&dh, &st);
+  printf("live %zu dead %zu reclaimed %zu runs %zu\n", st.live, st.dead,
+         st.reclaimed, st.runs);
+
+  dlist_read_lock(&dh);
+  dlist_for_each_entry(p, &dh, struct mystruct, node) printf("%d,", p->a);
+  printf("\n");
+  dlist_read_unlock(&dh);
+
+  dlist_destroy(&dh);
+}
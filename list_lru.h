@@ -0,0 +1,346 @@
+#ifndef LIST_LRU_H_20261018
+#define LIST_LRU_H_20261018
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "list.h"
+/*
+ * Sharded list, in the style of the kernel's list_lru.
+ *
+ * One list_head and one lock per CPU or per NUMA node, each on its own
+ * cache line.  Entries are added to the shard of the calling CPU and
+ * remember it, so deletion goes to the owning shard without a lookup.
+ * The total count is the sum of the per-shard counters read without
+ * locks, hence approximate.  list_lru_walk() visits every shard with a
+ * per-shard budget and lets a callback isolate entries, which is what a
+ * reclaimer needs.
+ */
+
+#define LIST_LRU_CACHELINE 64
+
+enum list_lru_shard_by {
+  LIST_LRU_PER_CPU,
+  LIST_LRU_PER_NODE,
+};
+
+/* Return values of the list_lru_walk() callback. */
+enum lru_status {
+  LRU_REMOVED, /* entry was isolated from the shard */
+  LRU_ROTATE,  /* entry stays, move it to the shard tail */
+  LRU_SKIP,    /* entry stays where it is */
+  LRU_STOP,    /* stop walking this shard */
+};
+
+struct list_lru_entry {
+  struct list_head list;
+  int shard; /* owning shard, -1 while on no shard */
+};
+
+#define LIST_LRU_ENTRY_INIT(name) \
+  { LIST_HEAD_INIT((name).list), -1 }
+
+/**
+ * list_lru_entry_init - prepare an entry that is on no shard
+ * @entry: the entry.
+ */
+static void list_lru_entry_init(struct list_lru_entry *entry) {
+  INIT_LIST_HEAD(&entry->list);
+  entry->shard = -1;
+}
+
+struct list_lru_one {
+  pthread_mutex_t lock;
+  struct list_head list;
+  long nr_items;
+} __attribute__((aligned(LIST_LRU_CACHELINE)));
+
+struct list_lru {
+  struct list_lru_one *shards;
+  int nr_shards;
+  int nr_cpus;
+  enum list_lru_shard_by shard_by;
+  unsigned walk_start;
+};
+
+/*
+ * Count NUMA nodes from sysfs; 1 if sysfs does not expose them.
+ */
+static int __list_lru_nr_nodes(void) {
+  char path[64];
+  int n = 0;
+
+  for (;;) {
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", n);
+    if (access(path, F_OK)) break;
+    n++;
+  }
+  return n ? n : 1;
+}
+
+/**
+ * list_lru_init - initialize a sharded list
+ * @lru: the list to initialize.
+ * @shard_by: whether to keep one shard per CPU or per NUMA node.
+ *
+ * Returns 0, or -ENOMEM.
+ */
+static int list_lru_init(struct list_lru *lru,
+                         enum list_lru_shard_by shard_by) {
+  long cpus = sysconf(_SC_NPROCESSORS_CONF);
+  void *mem;
+  int i;
+
+  lru->nr_cpus = cpus > 0 ? (int)cpus : 1;
+  lru->shard_by = shard_by;
+  lru->nr_shards =
+      shard_by == LIST_LRU_PER_NODE ? __list_lru_nr_nodes() : lru->nr_cpus;
+  lru->walk_start = 0;
+  if (posix_memalign(&mem, LIST_LRU_CACHELINE,
+                     sizeof(struct list_lru_one) * lru->nr_shards))
+    return -ENOMEM;
+  lru->shards = (struct list_lru_one *)mem;
+  for (i = 0; i < lru->nr_shards; i++) {
+    pthread_mutex_init(&lru->shards[i].lock, NULL);
+    INIT_LIST_HEAD(&lru->shards[i].list);
+    lru->shards[i].nr_items = 0;
+  }
+  return 0;
+}
+
+/**
+ * list_lru_destroy - free the shards
+ * @lru: the list to destroy.
+ *
+ * Entries still on the list are not touched.
+ */
+static void list_lru_destroy(struct list_lru *lru) {
+  int i;
+
+  for (i = 0; i < lru->nr_shards; i++)
+    pthread_mutex_destroy(&lru->shards[i].lock);
+  free(lru->shards);
+  lru->shards = NULL;
+  lru->nr_shards = 0;
+}
+
+/**
+ * list_lru_local_shard - index of the shard local to the calling thread
+ * @lru: the sharded list.
+ *
+ * With _GNU_SOURCE defined before the first include, glibc's
+ * sched_getcpu() and getcpu() are used, which read the CPU from rseq or
+ * the vDSO; otherwise this falls back to the getcpu system call.
+ */
+static int list_lru_local_shard(const struct list_lru *lru) {
+  unsigned cpu = 0, node = 0;
+
+#if defined(_GNU_SOURCE) && defined(__GLIBC__)
+  /* vDSO / rseq, no kernel entry on the add path */
+  if (lru->shard_by == LIST_LRU_PER_CPU) {
+    int c = sched_getcpu();
+
+    return c < 0 ? 0 : c % lru->nr_shards;
+  }
+#if __GLIBC_PREREQ(2, 29)
+  if (getcpu(&cpu, &node)) return 0;
+  return (int)node % lru->nr_shards;
+#endif
+#endif
+  if (syscall(SYS_getcpu, &cpu, &node, NULL)) return 0;
+  if (lru->shard_by == LIST_LRU_PER_NODE) return (int)node % lru->nr_shards;
+  return (int)cpu % lru->nr_shards;
+}
+
+/**
+ * list_lru_add_shard - add an entry to a given shard
+ * @lru: the sharded list.
+ * @entry: the entry to add, set up with list_lru_entry_init().
+ * @shard: the shard index.
+ *
+ * Returns 1 if the entry was added, 0 if it already was on a list.
+ */
+static int list_lru_add_shard(struct list_lru *lru,
+                              struct list_lru_entry *entry, int shard) {
+  struct list_lru_one *one = &lru->shards[shard];
+  int added = 0;
+
+  pthread_mutex_lock(&one->lock);
+  if (list_empty(&entry->list)) {
+    list_add_tail(&entry->list, &one->list);
+    __atomic_store_n(&entry->shard, shard, __ATOMIC_RELAXED);
+    __atomic_store_n(&one->nr_items, one->nr_items + 1, __ATOMIC_RELAXED);
+    added = 1;
+  }
+  pthread_mutex_unlock(&one->lock);
+  return added;
+}
+
+/**
+ * list_lru_add - add an entry to the local shard
+ * @lru: the sharded list.
+ * @entry: the entry to add, set up with list_lru_entry_init().
+ *
+ * Returns 1 if the entry was added, 0 if it already was on a list.
+ */
+static int list_lru_add(struct list_lru *lru, struct list_lru_entry *entry) {
+  return list_lru_add_shard(lru, entry, list_lru_local_shard(lru));
+}
+
+/**
+ * list_lru_del - remove an entry from its owning shard
+ * @lru: the sharded list.
+ * @entry: the entry to remove.
+ *
+ * The owning shard is read without a lock, so it is checked again under
+ * that shard's lock; if a concurrent add or walk moved the entry in
+ * between, the lookup is retried.
+ *
+ * Returns 1 if the entry was removed, 0 if it was not on the list.
+ */
+static int list_lru_del(struct list_lru *lru, struct list_lru_entry *entry) {
+  struct list_lru_one *one;
+  int shard, removed;
+
+  for (;;) {
+    shard = __atomic_load_n(&entry->shard, __ATOMIC_RELAXED);
+    if (shard < 0) return 0;
+    one = &lru->shards[shard];
+    pthread_mutex_lock(&one->lock);
+    if (__atomic_load_n(&entry->shard, __ATOMIC_RELAXED) == shard) break;
+    pthread_mutex_unlock(&one->lock);
+  }
+  removed = !list_empty(&entry->list);
+  if (removed) {
+    list_del_init(&entry->list);
+    __atomic_store_n(&entry->shard, -1, __ATOMIC_RELAXED);
+    __atomic_store_n(&one->nr_items, one->nr_items - 1, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&one->lock);
+  return removed;
+}
+
+/**
+ * list_lru_count_shard - number of entries on one shard, without locking
+ * @lru: the sharded list.
+ * @shard: the shard index.
+ */
+static long list_lru_count_shard(const struct list_lru *lru, int shard) {
+  return __atomic_load_n(&lru->shards[shard].nr_items, __ATOMIC_RELAXED);
+}
+
+/**
+ * list_lru_count - approximate number of entries on all shards
+ * @lru: the sharded list.
+ */
+static long list_lru_count(const struct list_lru *lru) {
+  long n = 0;
+  int i;
+
+  for (i = 0; i < lru->nr_shards; i++) n += list_lru_count_shard(lru, i);
+  return n;
+}
+
+/**
+ * list_lru_isolate - remove an entry from within a walk callback
+ * @one: the shard passed to the callback.
+ * @entry: the entry to remove.
+ */
+static void list_lru_isolate(struct list_lru_one *one,
+                             struct list_lru_entry *entry) {
+  list_del_init(&entry->list);
+  __atomic_store_n(&entry->shard, -1, __ATOMIC_RELAXED);
+  __atomic_store_n(&one->nr_items, one->nr_items - 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * list_lru_isolate_move - move an entry to a private list within a walk
+ * @one: the shard passed to the callback.
+ * @entry: the entry to move.
+ * @head: the private list, usually a dispose list freed after the walk.
+ */
+static void list_lru_isolate_move(struct list_lru_one *one,
+                                  struct list_lru_entry *entry,
+                                  struct list_head *head) {
+  list_move_tail(&entry->list, head);
+  __atomic_store_n(&entry->shard, -1, __ATOMIC_RELAXED);
+  __atomic_store_n(&one->nr_items, one->nr_items - 1, __ATOMIC_RELAXED);
+}
+
+typedef enum lru_status (*list_lru_walk_cb)(struct list_lru_entry *entry,
+                                            struct list_lru_one *one,
+                                            void *arg);
+
+/**
+ * list_lru_walk_shard - walk one shard from its head
+ * @lru: the sharded list.
+ * @shard: the shard index.
+ * @isolate: callback run on each entry with the shard lock held.
+ * @arg: passed to @isolate.
+ * @nr_to_walk: maximum number of entries to visit.
+ *
+ * Returns the number of entries @isolate reported as LRU_REMOVED.
+ */
+static long list_lru_walk_shard(struct list_lru *lru, int shard,
+                                list_lru_walk_cb isolate, void *arg,
+                                long nr_to_walk) {
+  struct list_lru_one *one = &lru->shards[shard];
+  struct list_head *pos, *n;
+  struct list_lru_entry *entry;
+  long isolated = 0;
+
+  pthread_mutex_lock(&one->lock);
+  list_for_each_safe(pos, n, &one->list) {
+    if (nr_to_walk-- <= 0) break;
+    entry = container_of(pos, struct list_lru_entry, list);
+    switch (isolate(entry, one, arg)) {
+      case LRU_REMOVED:
+        isolated++;
+        break;
+      case LRU_ROTATE:
+        list_move_tail(pos, &one->list);
+        break;
+      case LRU_SKIP:
+        break;
+      case LRU_STOP:
+        goto out;
+    }
+  }
+out:
+  pthread_mutex_unlock(&one->lock);
+  return isolated;
+}
+
+/**
+ * list_lru_walk - walk all shards with a per-shard budget
+ * @lru: the sharded list.
+ * @isolate: callback run on each entry with its shard lock held.
+ * @arg: passed to @isolate.
+ * @nr_to_walk: total number of entries to visit, split evenly across
+ *    shards.
+ *
+ * Successive calls start from successive shards so no shard is starved
+ * when the budget is small.  Returns the number of entries isolated.
+ */
+static long list_lru_walk(struct list_lru *lru, list_lru_walk_cb isolate,
+                          void *arg, long nr_to_walk) {
+  long budget = nr_to_walk / lru->nr_shards;
+  long isolated = 0;
+  int i, shard;
+
+  if (budget < 1) budget = 1;
+  shard = (int)(__atomic_fetch_add(&lru->walk_start, 1, __ATOMIC_RELAXED) %
+                (unsigned)lru->nr_shards);
+  for (i = 0; i < lru->nr_shards && nr_to_walk > 0; i++) {
+    if (budget > nr_to_walk) budget = nr_to_walk;
+    isolated += list_lru_walk_shard(lru, shard, isolate, arg, budget);
+    nr_to_walk -= budget;
+    if (++shard == lru->nr_shards) shard = 0;
+  }
+  return isolated;
+}
+
+#endif  // LIST_LRU_H_20261018
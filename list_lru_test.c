@@ -0,0 +1,62 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_lru.h"
+
+#define NR_THREADS 4
+#define PER_THREAD 1000
+
+struct mystruct {
+  int a;
+  struct list_lru_entry lru;
+};
+
+static struct list_lru lru;
+
+static void *adder(void *arg) {
+  int i;
+  struct mystruct *p;
+  for (i = 0; i < PER_THREAD; i++) {
+    p = (struct mystruct *)malloc(sizeof(struct mystruct));
+    p->a = i;
+    list_lru_entry_init(&p->lru);
+    list_lru_add(&lru, &p->lru);
+    if (i % 4 == 0) {
+      list_lru_del(&lru, &p->lru);
+      free(p);
+    }
+  }
+  return NULL;
+}
+
+static enum lru_status evict(struct list_lru_entry *entry,
+                             struct list_lru_one *one, void *arg) {
+  struct mystruct *p = list_entry(entry, struct mystruct, lru);
+  if (p->a % 2) return LRU_ROTATE;
+  list_lru_isolate_move(one, entry, (struct list_head *)arg);
+  return LRU_REMOVED;
+}
+
+int main() {
+  int i;
+  long n;
+  pthread_t th[NR_THREADS];
+  struct list_head dispose = LIST_HEAD_INIT(dispose);
+  struct mystruct *p, *t;
+
+  list_lru_init(&lru, LIST_LRU_PER_CPU);
+  for (i = 0; i < NR_THREADS; i++) pthread_create(&th[i], NULL, adder, NULL);
+  for (i = 0; i < NR_THREADS; i++) pthread_join(th[i], NULL);
+  printf("shards %d count %ld\n", lru.nr_shards, list_lru_count(&lru));
+
+  do {
+    n = list_lru_walk(&lru, evict, &dispose, 256);
+    printf("isolated %ld left %ld\n", n, list_lru_count(&lru));
+  } while (n);
+
+  list_for_each_entry_safe(p, t, &dispose, struct mystruct, lru.list) free(p);
+  list_lru_destroy(&lru);
+}
@@ -0,0 +1,327 @@
+#ifndef LIST_PARALLEL_H_20261018
+#define LIST_PARALLEL_H_20261018
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+/*
+ * Parallel for-each over a list_head.
+ *
+ * One linking pass records the first entry of every @chunk entries;
+ * workers of a list_par_pool then claim chunks through an atomic index,
+ * so a slow chunk does not hold back the rest.  The calling thread
+ * takes part as worker 0.  Each worker folds its entries into a private
+ * accumulator and the accumulators are reduced into the result once all
+ * chunks are done, so reduce() must be associative and commutative.
+ *
+ * Accumulators are padded to whole cache lines, so workers updating
+ * their own on every entry do not bounce a shared line between cores.
+ * Lists shorter than the threshold run serially on the calling thread,
+ * where the partitioning pass and the wakeups would cost more than they
+ * save.  The list must not be modified while a walk is running, by the
+ * callback or by anyone else.
+ */
+
+#define LIST_PAR_CHUNK 1024
+#define LIST_PAR_CACHELINE 64
+#define LIST_PAR_STACK_CHUNKS 64
+
+struct list_par_ops {
+  /* called for every entry; @acc is the worker's accumulator or NULL */
+  void (*fn)(struct list_head *pos, void *arg, void *acc);
+  size_t acc_size; /* 0 for no reduction */
+  void (*acc_init)(void *acc, void *arg);
+  void (*reduce)(void *result, const void *acc, void *arg);
+};
+
+struct list_par_job {
+  const struct list_par_ops *ops;
+  void *arg;
+  struct list_head *head;
+  struct list_head **starts;
+  size_t nr_chunks;
+  size_t next_chunk;
+  char *accs;
+  size_t acc_stride; /* acc_size rounded up to whole cache lines */
+};
+
+struct list_par_pool {
+  pthread_mutex_t walk_lock; /* one walk at a time per pool */
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  pthread_t *threads;
+  int nr_threads; /* helper threads, not counting the caller */
+  int nr_started;
+  int nr_busy;
+  int stop;
+  unsigned long generation;
+  struct list_par_job *job;
+};
+
+static void __list_par_run(struct list_par_job *job, int worker) {
+  void *acc = job->ops->acc_size
+                  ? job->accs + (size_t)worker * job->acc_stride
+                  : NULL;
+  struct list_head *pos, *end;
+  size_t i;
+
+  for (;;) {
+    i = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+    if (i >= job->nr_chunks) break;
+    end = i + 1 < job->nr_chunks ? job->starts[i + 1] : job->head;
+    for (pos = job->starts[i]; pos != end; pos = pos->next)
+      job->ops->fn(pos, job->arg, acc);
+  }
+}
+
+static void *__list_par_thread(void *data) {
+  struct list_par_pool *pool = (struct list_par_pool *)data;
+  unsigned long seen = 0;
+  int index;
+
+  pthread_mutex_lock(&pool->lock);
+  index = ++pool->nr_started; /* 1..nr_threads, 0 is the caller */
+  if (index == pool->nr_threads) pthread_cond_signal(&pool->done);
+  for (;;) {
+    while (!pool->stop && pool->generation == seen)
+      pthread_cond_wait(&pool->work, &pool->lock);
+    if (pool->stop) break;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    __list_par_run(pool->job, index);
+    pthread_mutex_lock(&pool->lock);
+    if (!--pool->nr_busy) pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+/**
+ * list_par_pool_init - start a worker pool
+ * @pool: the pool to initialize.
+ * @nr_threads: number of helper threads; the caller of
+ *    list_for_each_parallel() works too.
+ *
+ * Returns 0, -ENOMEM, or a negative errno from pthread_create().
+ */
+static int list_par_pool_init(struct list_par_pool *pool, int nr_threads) {
+  int i, err;
+
+  pthread_mutex_init(&pool->walk_lock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->nr_threads = nr_threads > 0 ? nr_threads : 0;
+  pool->nr_started = 0;
+  pool->nr_busy = 0;
+  pool->stop = 0;
+  pool->generation = 0;
+  pool->job = NULL;
+  pool->threads = NULL;
+  if (!pool->nr_threads) return 0;
+  pool->threads =
+      (pthread_t *)malloc(sizeof(pthread_t) * (size_t)pool->nr_threads);
+  if (!pool->threads) return -ENOMEM;
+  for (i = 0; i < pool->nr_threads; i++) {
+    err = pthread_create(&pool->threads[i], NULL, __list_par_thread, pool);
+    if (err) {
+      pool->nr_threads = i;
+      return -err;
+    }
+  }
+  /* wait until every helper has picked its index */
+  pthread_mutex_lock(&pool->lock);
+  while (pool->nr_started < pool->nr_threads)
+    pthread_cond_wait(&pool->done, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+  return 0;
+}
+
+/**
+ * list_par_pool_destroy - stop and join the helper threads
+ * @pool: the pool to destroy.
+ */
+static void list_par_pool_destroy(struct list_par_pool *pool) {
+  int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->nr_threads; i++) pthread_join(pool->threads[i], NULL);
+  free(pool->threads);
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->work);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_mutex_destroy(&pool->walk_lock);
+}
+
+static void __list_par_serial(struct list_head *head,
+                              const struct list_par_ops *ops, void *arg,
+                              void *result) {
+  struct list_head *pos;
+  void *acc = NULL;
+
+  if (ops->acc_size) {
+    acc = malloc(ops->acc_size);
+    if (!acc) {
+      /* fold straight into the result rather than fail */
+      list_for_each(pos, head) ops->fn(pos, arg, result);
+      return;
+    }
+    ops->acc_init(acc, arg);
+  }
+  list_for_each(pos, head) ops->fn(pos, arg, acc);
+  if (acc) {
+    ops->reduce(result, acc, arg);
+    free(acc);
+  }
+}
+
+/**
+ * list_for_each_parallel - run a callback on every entry using a pool
+ * @pool: the worker pool, or NULL to run serially.
+ * @head: the list, which must not change during the call.
+ * @ops: per-entry callback and optional reduction.
+ * @arg: passed to every callback.
+ * @result: accumulators are reduced into it; it is not initialized here.
+ * @threshold: lists with fewer entries run serially; 0 means
+ *    4 * @chunk per worker.
+ * @chunk: entries per chunk, 0 for LIST_PAR_CHUNK.
+ *
+ * One walk measures the list and records chunk starts, without calling
+ * @ops->fn.  A list below @threshold is then run serially; otherwise every
+ * chunk goes to the pool.  The chunk table lives on the stack for up to
+ * LIST_PAR_STACK_CHUNKS chunks, so short lists allocate nothing.
+ * Several threads may share a pool; their parallel walks take turns.
+ *
+ * Returns 0, or -ENOMEM if the accumulators or the chunk table could not
+ * be allocated, in which case nothing has been processed.
+ */
+static int list_for_each_parallel(struct list_par_pool *pool,
+                                  struct list_head *head,
+                                  const struct list_par_ops *ops, void *arg,
+                                  void *result, size_t threshold,
+                                  size_t chunk) {
+  struct list_head *stack_starts[LIST_PAR_STACK_CHUNKS];
+  struct list_par_job job;
+  struct list_head *pos;
+  size_t n = 0, cap = LIST_PAR_STACK_CHUNKS, i, stride = 0;
+  int workers = pool ? pool->nr_threads + 1 : 1;
+  void *p;
+
+  if (!chunk) chunk = LIST_PAR_CHUNK;
+  if (!threshold) threshold = 4 * chunk * (size_t)workers;
+  if (workers == 1) {
+    __list_par_serial(head, ops, arg, result);
+    return 0;
+  }
+
+  /* the partitioning pass: one walk, recording chunk starts */
+  job.starts = stack_starts;
+  list_for_each(pos, head) {
+    if (n % chunk == 0) {
+      if (n / chunk == cap) {
+        p = malloc(2 * cap * sizeof(*job.starts));
+        if (!p) {
+          if (job.starts != stack_starts) free(job.starts);
+          return -ENOMEM;
+        }
+        memcpy(p, job.starts, cap * sizeof(*job.starts));
+        if (job.starts != stack_starts) free(job.starts);
+        job.starts = (struct list_head **)p;
+        cap *= 2;
+      }
+      job.starts[n / chunk] = pos;
+    }
+    n++;
+  }
+  if (n < threshold) {
+    if (job.starts != stack_starts) free(job.starts);
+    __list_par_serial(head, ops, arg, result);
+    return 0;
+  }
+
+  /* one accumulator per worker, each on its own cache lines */
+  job.accs = NULL;
+  if (ops->acc_size) {
+    stride = (ops->acc_size + LIST_PAR_CACHELINE - 1) &
+             ~(size_t)(LIST_PAR_CACHELINE - 1);
+    if (posix_memalign(&p, LIST_PAR_CACHELINE, stride * (size_t)workers)) {
+      if (job.starts != stack_starts) free(job.starts);
+      return -ENOMEM;
+    }
+    job.accs = (char *)p;
+    for (i = 0; i < (size_t)workers; i++)
+      ops->acc_init(job.accs + i * stride, arg);
+  }
+
+  job.ops = ops;
+  job.arg = arg;
+  job.head = head;
+  job.nr_chunks = (n + chunk - 1) / chunk;
+  job.next_chunk = 0;
+  job.acc_stride = stride;
+
+  pthread_mutex_lock(&pool->walk_lock);
+  pthread_mutex_lock(&pool->lock);
+  pool->job = &job;
+  pool->nr_busy = pool->nr_threads;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->work);
+  pthread_mutex_unlock(&pool->lock);
+
+  __list_par_run(&job, 0);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->nr_busy) pthread_cond_wait(&pool->done, &pool->lock);
+  pool->job = NULL;
+  pthread_mutex_unlock(&pool->lock);
+  pthread_mutex_unlock(&pool->walk_lock);
+
+  if (job.accs) {
+    for (i = 0; i < (size_t)workers; i++)
+      ops->reduce(result, job.accs + i * stride, arg);
+    free(job.accs);
+  }
+  if (job.starts != stack_starts) free(job.starts);
+  return 0;
+}
+
+/**
+ * DEFINE_LIST_PAR_ENTRY_OPS - define list_par_ops for a typed callback
+ * @name: name of the struct list_par_ops to define.
+ * @type: the type of the struct the list_head is embedded in.
+ * @member: the name of the list_head within the struct.
+ * @fn: void fn(type *entry, void *arg, void *acc).
+ * @acc_size: as in struct list_par_ops.
+ * @acc_init: as in struct list_par_ops.
+ * @reduce: as in struct list_par_ops.
+ *
+ * Emits a trampoline that converts each list_head back to its entry.
+ */
+#define DEFINE_LIST_PAR_ENTRY_OPS(name, type, member, fn, acc_size, acc_init, \
+                                  reduce)                                    \
+  static void __##name##_fn(struct list_head *pos, void *arg, void *acc) {    \
+    fn(list_entry(pos, type, member), arg, acc);                              \
+  }                                                                           \
+  static const struct list_par_ops name = {__##name##_fn, acc_size, acc_init, \
+                                           reduce}
+
+/**
+ * list_for_each_entry_parallel - run a typed callback on every entry
+ * @pool: the worker pool, or NULL to run serially.
+ * @head: the list, which must not change during the call.
+ * @ops: struct list_par_ops defined with DEFINE_LIST_PAR_ENTRY_OPS().
+ * @arg: passed to every callback.
+ * @result: accumulators are reduced into it.
+ *
+ * list_for_each_parallel() with the default threshold and chunk size.
+ */
+#define list_for_each_entry_parallel(pool, head, ops, arg, result) \
+  list_for_each_parallel(pool, head, &(ops), arg, result, 0, 0)
+
+#endif  // LIST_PARALLEL_H_20261018
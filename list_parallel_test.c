@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "list_parallel.h"
+
+#define NR 2000000
+
+struct mystruct {
+  unsigned long a;
+  struct list_head list;
+};
+
+struct sum {
+  unsigned long sum;
+  unsigned long n;
+};
+
+/* a few hundred cycles of work per entry, like a checksum */
+static void work(struct list_head *pos, void *arg, void *acc) {
+  struct mystruct *p = list_entry(pos, struct mystruct, list);
+  struct sum *s = (struct sum *)acc;
+  unsigned long h = p->a;
+  int i;
+  for (i = 0; i < 64; i++)
+    h = h * 6364136223846793005UL + 1442695040888963407UL;
+  s->sum += h;
+  s->n++;
+}
+
+/* the same work, written against the entry type */
+static void work_entry(struct mystruct *p, void *arg, void *acc) {
+  work(&p->list, arg, acc);
+}
+
+static void acc_init(void *acc, void *arg) {
+  memset(acc, 0, sizeof(struct sum));
+}
+
+static void reduce(void *result, const void *acc, void *arg) {
+  struct sum *r = (struct sum *)result;
+  const struct sum *s = (const struct sum *)acc;
+  r->sum += s->sum;
+  r->n += s->n;
+}
+
+DEFINE_LIST_PAR_ENTRY_OPS(entry_ops, struct mystruct, list, work_entry,
+                          sizeof(struct sum), acc_init, reduce);
+
+struct caller {
+  struct list_par_pool *pool;
+  struct list_head *head;
+  const struct list_par_ops *ops;
+  struct sum result;
+};
+
+static void *caller(void *arg) {
+  struct caller *c = (struct caller *)arg;
+  list_for_each_parallel(c->pool, c->head, c->ops, NULL, &c->result, 0, 0);
+  return NULL;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+  long i;
+  double t;
+  struct list_head head = LIST_HEAD_INIT(head);
+  struct list_par_pool pool;
+  struct list_par_ops ops = {work, sizeof(struct sum), acc_init, reduce};
+  struct sum serial = {0, 0}, par = {0, 0}, small = {0, 0}, odd = {0, 0};
+  struct sum typed = {0, 0};
+  struct mystruct *items = (struct mystruct *)malloc(NR * sizeof(*items));
+
+  for (i = 0; i < NR; i++) {
+    items[i].a = i;
+    list_add_tail(&items[i].list, &head);
+  }
+  list_par_pool_init(&pool, 3);
+
+  t = now();
+  list_for_each_parallel(NULL, &head, &ops, NULL, &serial, 0, 0);
+  printf("serial   n %lu %.1f ms\n", serial.n, (now() - t) * 1e3);
+
+  t = now();
+  list_for_each_parallel(&pool, &head, &ops, NULL, &par, 0, 0);
+  printf("parallel n %lu %.1f ms\n", par.n, (now() - t) * 1e3);
+  printf("same result %d\n", serial.sum == par.sum);
+
+  /* below the threshold: runs serially */
+  list_for_each_parallel(&pool, &head, &ops, NULL, &small, 2 * NR, 0);
+  printf("threshold n %lu same %d\n", small.n, small.sum == serial.sum);
+
+  /* small threshold, odd-sized chunks */
+  list_for_each_parallel(&pool, &head, &ops, NULL, &odd, 1000, 777);
+  printf("odd chunks n %lu same %d\n", odd.n, odd.sum == serial.sum);
+
+  list_for_each_entry_parallel(&pool, &head, entry_ops, NULL, &typed);
+  printf("typed n %lu same %d\n", typed.n, typed.sum == serial.sum);
+
+  /* two threads sharing the pool */
+  {
+    struct caller c[2] = {{&pool, &head, &ops, {0, 0}},
+                          {&pool, &head, &ops, {0, 0}}};
+    pthread_t th[2];
+    for (i = 0; i < 2; i++) pthread_create(&th[i], NULL, caller, &c[i]);
+    for (i = 0; i < 2; i++) pthread_join(th[i], NULL);
+    printf("shared pool same %d %d\n", c[0].result.sum == serial.sum,
+           c[1].result.sum == serial.sum);
+  }
+
+  list_par_pool_destroy(&pool);
+  free(items);
+}
@@ -0,0 +1,209 @@
+#ifndef LIST_PRIO_H_20261018
+#define LIST_PRIO_H_20261018
+#include <stdint.h>
+
+#include "list.h"
+/*
+ * Fixed-priority run-queue: one list_head per priority level plus a
+ * bitmap of the non-empty levels.  Level 0 is the highest priority.
+ * Enqueue, dequeue and pick-next are O(1); pick-next scans at most
+ * PRIO_BITMAP_WORDS words with find-first-set.  Entries within a level
+ * are FIFO, and prio_rotate() round-robins a level with
+ * list_rotate_left().
+ *
+ * Define PRIO_QUEUE_LEVELS before including this file to change the
+ * number of levels (default 140, as in the Linux O(1) scheduler).
+ */
+
+#ifndef PRIO_QUEUE_LEVELS
+#define PRIO_QUEUE_LEVELS 140
+#endif
+
+#define PRIO_BITMAP_WORDS ((PRIO_QUEUE_LEVELS + 63) / 64)
+
+struct prio_node {
+  struct list_head list;
+  unsigned prio;
+};
+
+struct prio_queue {
+  uint64_t bitmap[PRIO_BITMAP_WORDS];
+  size_t nr;
+  struct list_head queue[PRIO_QUEUE_LEVELS];
+};
+
+/**
+ * prio_queue_init - initialize a run-queue
+ * @pq: the run-queue to initialize.
+ */
+static void prio_queue_init(struct prio_queue *pq) {
+  unsigned i;
+
+  for (i = 0; i < PRIO_BITMAP_WORDS; i++) pq->bitmap[i] = 0;
+  for (i = 0; i < PRIO_QUEUE_LEVELS; i++) INIT_LIST_HEAD(&pq->queue[i]);
+  pq->nr = 0;
+}
+
+/**
+ * prio_queue_empty - tests whether a run-queue is empty
+ * @pq: the run-queue to test.
+ */
+static int prio_queue_empty(const struct prio_queue *pq) { return !pq->nr; }
+
+/**
+ * prio_level_empty - tests whether a single level is empty
+ * @pq: the run-queue to test.
+ * @prio: the level to test.
+ */
+static int prio_level_empty(const struct prio_queue *pq, unsigned prio) {
+  return !(pq->bitmap[prio / 64] & ((uint64_t)1 << (prio % 64)));
+}
+
+static void __prio_set(struct prio_queue *pq, unsigned prio) {
+  pq->bitmap[prio / 64] |= (uint64_t)1 << (prio % 64);
+}
+
+static void __prio_clear(struct prio_queue *pq, unsigned prio) {
+  pq->bitmap[prio / 64] &= ~((uint64_t)1 << (prio % 64));
+}
+
+/**
+ * prio_enqueue - add an entry at the tail of its level
+ * @pq: the run-queue to add to.
+ * @node: the entry to add.
+ * @prio: the level, must be below PRIO_QUEUE_LEVELS.
+ */
+static void prio_enqueue(struct prio_queue *pq, struct prio_node *node,
+                         unsigned prio) {
+  node->prio = prio;
+  list_add_tail(&node->list, &pq->queue[prio]);
+  __prio_set(pq, prio);
+  pq->nr++;
+}
+
+/**
+ * prio_enqueue_head - add an entry at the head of its level
+ * @pq: the run-queue to add to.
+ * @node: the entry to add.
+ * @prio: the level, must be below PRIO_QUEUE_LEVELS.
+ *
+ * Useful to put back an entry that was preempted before its slice ended.
+ */
+static void prio_enqueue_head(struct prio_queue *pq, struct prio_node *node,
+                              unsigned prio) {
+  node->prio = prio;
+  list_add(&node->list, &pq->queue[prio]);
+  __prio_set(pq, prio);
+  pq->nr++;
+}
+
+/**
+ * prio_dequeue - remove an entry from the run-queue
+ * @pq: the run-queue @node is on.
+ * @node: the entry to remove.
+ */
+static void prio_dequeue(struct prio_queue *pq, struct prio_node *node) {
+  list_del_init(&node->list);
+  if (list_empty(&pq->queue[node->prio])) __prio_clear(pq, node->prio);
+  pq->nr--;
+}
+
+/**
+ * prio_first_level - find the highest non-empty priority level
+ * @pq: the run-queue to search.
+ *
+ * Returns the level, or PRIO_QUEUE_LEVELS if the run-queue is empty.
+ */
+static unsigned prio_first_level(const struct prio_queue *pq) {
+  unsigned i;
+
+  for (i = 0; i < PRIO_BITMAP_WORDS; i++)
+    if (pq->bitmap[i]) return i * 64 + __builtin_ctzll(pq->bitmap[i]);
+  return PRIO_QUEUE_LEVELS;
+}
+
+/**
+ * prio_pick_next - get the first entry of the highest non-empty level
+ * @pq: the run-queue to pick from.
+ *
+ * The entry stays queued.  Returns NULL if the run-queue is empty.
+ */
+static struct prio_node *prio_pick_next(const struct prio_queue *pq) {
+  unsigned prio = prio_first_level(pq);
+
+  if (prio == PRIO_QUEUE_LEVELS) return NULL;
+  return list_first_entry(&pq->queue[prio], struct prio_node, list);
+}
+
+/**
+ * prio_pop_next - dequeue the first entry of the highest non-empty level
+ * @pq: the run-queue to pop from.
+ *
+ * Returns NULL if the run-queue is empty.
+ */
+static struct prio_node *prio_pop_next(struct prio_queue *pq) {
+  struct prio_node *node = prio_pick_next(pq);
+
+  if (node) prio_dequeue(pq, node);
+  return node;
+}
+
+/**
+ * prio_change - move a queued entry to another level
+ * @pq: the run-queue @node is on.
+ * @node: the entry to move.
+ * @prio: the new level; the entry goes to its tail.
+ */
+static void prio_change(struct prio_queue *pq, struct prio_node *node,
+                        unsigned prio) {
+  unsigned old = node->prio;
+
+  if (old == prio) return;
+  list_move_tail(&node->list, &pq->queue[prio]);
+  if (list_empty(&pq->queue[old])) __prio_clear(pq, old);
+  node->prio = prio;
+  __prio_set(pq, prio);
+}
+
+/**
+ * prio_requeue - move a queued entry to the tail of its own level
+ * @pq: the run-queue @node is on.
+ * @node: the entry to move.
+ */
+static void prio_requeue(struct prio_queue *pq, struct prio_node *node) {
+  list_move_tail(&node->list, &pq->queue[node->prio]);
+}
+
+/**
+ * prio_rotate - round-robin a level
+ * @pq: the run-queue to rotate.
+ * @prio: the level whose first entry moves to its tail.
+ */
+static void prio_rotate(struct prio_queue *pq, unsigned prio) {
+  list_rotate_left(&pq->queue[prio]);
+}
+
+/**
+ * prio_entry - get the struct for this entry
+ * @ptr:    the &struct prio_node pointer.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the prio_node within the struct.
+ */
+#define prio_entry(ptr, type, member) container_of(ptr, type, member)
+
+/**
+ * prio_for_each_entry - iterate over a run-queue in pick order
+ * @pos:    the type * to use as a loop cursor.
+ * @prio:    unsigned to use as the level cursor.
+ * @pq:    the run-queue.
+ * @member:    the name of the prio_node within the struct.
+ *
+ * Visits every entry, highest level first.  Do not modify the run-queue
+ * in the loop body.
+ */
+#define prio_for_each_entry(pos, prio, pq, type, member)      \
+  for (prio = 0; prio < PRIO_QUEUE_LEVELS; prio++)            \
+    if (!prio_level_empty(pq, prio))                          \
+      list_for_each_entry(pos, &(pq)->queue[prio], type, member.list)
+
+#endif  // LIST_PRIO_H_20261018
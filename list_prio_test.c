@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_prio.h"
+
+struct mystruct {
+  int a;
+  struct prio_node node;
+};
+
+int main() {
+  int i = 0;
+  unsigned prio;
+  struct prio_queue pq;
+  struct prio_node *n;
+  struct mystruct *p, items[10];
+
+  prio_queue_init(&pq);
+  for (i = 0; i < 10; i++) {
+    items[i].a = i;
+    prio_enqueue(&pq, &items[i].node, (i * 37) % PRIO_QUEUE_LEVELS);
+  }
+
+  prio_for_each_entry(p, prio, &pq, struct mystruct, node) {
+    printf("%d@%u,", p->a, prio);
+  }
+  printf("\n");
+
+  prio_change(&pq, &items[9].node, 0);
+  prio_dequeue(&pq, &items[0].node);
+  prio_enqueue(&pq, &items[0].node, 0);
+  prio_rotate(&pq, 0);
+
+  while ((n = prio_pop_next(&pq))) {
+    p = prio_entry(n, struct mystruct, node);
+    printf("%d@%u,", p->a, n->prio);
+  }
+  printf("\n");
+}
@@ -0,0 +1,220 @@
+#ifndef LIST_QUEUE_H_20261018
+#define LIST_QUEUE_H_20261018
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "list.h"
+/*
+ * Blocking multi-producer multi-consumer queue of list_head entries.
+ *
+ * Producers may hand over a whole pre-built list with one
+ * list_splice_tail_init(), and consumers take up to N entries, or
+ * everything, in a single critical section with list_cut_position() or
+ * list_splice_tail_init().  A push wakes at most one waiting consumer; a
+ * consumer that leaves entries behind passes the wakeup on, so the number
+ * of wakeups follows the number of batches rather than the number of
+ * entries.
+ */
+
+struct lqueue {
+  struct list_head head;
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  size_t count;
+  unsigned waiters;
+  int closed;
+};
+
+/**
+ * lqueue_init - initialize a queue
+ * @q: the queue to initialize.
+ *
+ * Timeouts are measured against CLOCK_MONOTONIC.
+ */
+static void lqueue_init(struct lqueue *q) {
+  pthread_condattr_t attr;
+
+  INIT_LIST_HEAD(&q->head);
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&q->not_empty, &attr);
+  pthread_condattr_destroy(&attr);
+  q->count = 0;
+  q->waiters = 0;
+  q->closed = 0;
+}
+
+/**
+ * lqueue_destroy - release the queue's synchronization objects
+ * @q: the queue to destroy.
+ *
+ * Entries still queued are left on @q->head for the caller to free.
+ */
+static void lqueue_destroy(struct lqueue *q) {
+  pthread_cond_destroy(&q->not_empty);
+  pthread_mutex_destroy(&q->lock);
+}
+
+/**
+ * lqueue_count - number of queued entries, read without the lock
+ * @q: the queue to inspect.
+ */
+static size_t lqueue_count(const struct lqueue *q) {
+  return __atomic_load_n(&q->count, __ATOMIC_RELAXED);
+}
+
+/**
+ * lqueue_close - stop accepting entries and wake all consumers
+ * @q: the queue to close.
+ *
+ * Consumers still drain what is queued, then get -EPIPE.
+ */
+static void lqueue_close(struct lqueue *q) {
+  pthread_mutex_lock(&q->lock);
+  q->closed = 1;
+  pthread_cond_broadcast(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * lqueue_push_list - append a whole list of entries
+ * @q: the queue to add to.
+ * @list: the entries to add, reinitialised on success.
+ *
+ * The entries are counted before the lock is taken, so the queue's count
+ * always matches what is linked.
+ *
+ * Returns 0, or -EPIPE if the queue is closed.
+ */
+static int lqueue_push_list(struct lqueue *q, struct list_head *list) {
+  struct list_head *pos;
+  size_t n = 0;
+
+  if (list_empty(list)) return 0;
+  list_for_each(pos, list) n++;
+  pthread_mutex_lock(&q->lock);
+  if (q->closed) {
+    pthread_mutex_unlock(&q->lock);
+    return -EPIPE;
+  }
+  list_splice_tail_init(list, &q->head);
+  __atomic_store_n(&q->count, q->count + n, __ATOMIC_RELAXED);
+  if (q->waiters) pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+  return 0;
+}
+
+/**
+ * lqueue_push - append a single entry
+ * @q: the queue to add to.
+ * @entry: the entry to add.
+ *
+ * Returns 0, or -EPIPE if the queue is closed.
+ */
+static int lqueue_push(struct lqueue *q, struct list_head *entry) {
+  pthread_mutex_lock(&q->lock);
+  if (q->closed) {
+    pthread_mutex_unlock(&q->lock);
+    return -EPIPE;
+  }
+  list_add_tail(entry, &q->head);
+  __atomic_store_n(&q->count, q->count + 1, __ATOMIC_RELAXED);
+  if (q->waiters) pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+  return 0;
+}
+
+/*
+ * Move up to @max entries (all if @max is 0) to the tail of @out.
+ * Caller holds the lock and the queue is not empty.
+ */
+static size_t __lqueue_take(struct lqueue *q, struct list_head *out,
+                            size_t max) {
+  struct list_head cut;
+  struct list_head *entry;
+  size_t n;
+
+  if (max == 0 || max >= q->count) {
+    n = q->count;
+    list_splice_tail_init(&q->head, out);
+  } else {
+    entry = q->head.next;
+    for (n = 1; n < max; n++) entry = entry->next;
+    list_cut_position(&cut, &q->head, entry);
+    list_splice_tail(&cut, out);
+  }
+  __atomic_store_n(&q->count, q->count - n, __ATOMIC_RELAXED);
+  return n;
+}
+
+/**
+ * lqueue_pop_batch - take up to @max entries, waiting if necessary
+ * @q: the queue to take from.
+ * @out: list the entries are appended to, in queue order.
+ * @max: maximum number of entries to take, 0 for all of them.
+ * @timeout_ms: how long to wait for the queue to become non-empty;
+ *    0 does not wait, a negative value waits forever.
+ *
+ * Returns the number of entries taken, -ETIMEDOUT if none arrived in
+ * time, or -EPIPE if the queue is closed and empty.
+ */
+static long lqueue_pop_batch(struct lqueue *q, struct list_head *out,
+                             size_t max, long timeout_ms) {
+  struct timespec ts;
+  size_t n;
+  int err = 0;
+
+  if (timeout_ms > 0) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+    }
+  }
+
+  pthread_mutex_lock(&q->lock);
+  while (list_empty(&q->head)) {
+    if (q->closed) {
+      pthread_mutex_unlock(&q->lock);
+      return -EPIPE;
+    }
+    if (timeout_ms == 0 || err == ETIMEDOUT) {
+      pthread_mutex_unlock(&q->lock);
+      return -ETIMEDOUT;
+    }
+    q->waiters++;
+    if (timeout_ms < 0)
+      pthread_cond_wait(&q->not_empty, &q->lock);
+    else
+      err = pthread_cond_timedwait(&q->not_empty, &q->lock, &ts);
+    q->waiters--;
+  }
+  n = __lqueue_take(q, out, max);
+  if (q->waiters && !list_empty(&q->head)) pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+  return (long)n;
+}
+
+/**
+ * lqueue_pop - take a single entry, waiting if necessary
+ * @q: the queue to take from.
+ * @timeout_ms: as for lqueue_pop_batch().
+ *
+ * Returns the entry, or NULL on timeout or when the queue is closed and
+ * empty.
+ */
+static struct list_head *lqueue_pop(struct lqueue *q, long timeout_ms) {
+  struct list_head out = LIST_HEAD_INIT(out);
+  struct list_head *entry;
+
+  if (lqueue_pop_batch(q, &out, 1, timeout_ms) <= 0) return NULL;
+  entry = out.next;
+  list_del_init(entry);
+  return entry;
+}
+
+#endif  // LIST_QUEUE_H_20261018
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_queue.h"
+
+#define NR_PRODUCERS 4
+#define NR_BATCHES 100
+#define BATCH 250
+
+struct mystruct {
+  int a;
+  struct list_head list;
+};
+
+static struct lqueue q;
+
+static void *producer(void *arg) {
+  int i, j;
+  struct mystruct *p;
+  for (i = 0; i < NR_BATCHES; i++) {
+    struct list_head batch = LIST_HEAD_INIT(batch);
+    for (j = 0; j < BATCH; j++) {
+      p = (struct mystruct *)malloc(sizeof(struct mystruct));
+      p->a = 1;
+      list_add_tail(&p->list, &batch);
+    }
+    lqueue_push_list(&q, &batch);
+  }
+  return NULL;
+}
+
+static void *consumer(void *arg) {
+  long sum = 0, n;
+  struct mystruct *p, *t;
+  while (1) {
+    struct list_head out = LIST_HEAD_INIT(out);
+    n = lqueue_pop_batch(&q, &out, 128, -1);
+    if (n == -EPIPE) break;
+    list_for_each_entry_safe(p, t, &out, struct mystruct, list) {
+      sum += p->a;
+      free(p);
+    }
+  }
+  *(long *)arg = sum;
+  return NULL;
+}
+
+int main() {
+  int i;
+  long sums[2], total = 0;
+  pthread_t prod[NR_PRODUCERS], cons[2];
+
+  lqueue_init(&q);
+  printf("empty pop: %ld\n", lqueue_pop_batch(&q, NULL, 0, 10));
+  for (i = 0; i < 2; i++) pthread_create(&cons[i], NULL, consumer, &sums[i]);
+  for (i = 0; i < NR_PRODUCERS; i++)
+    pthread_create(&prod[i], NULL, producer, NULL);
+  for (i = 0; i < NR_PRODUCERS; i++) pthread_join(prod[i], NULL);
+  lqueue_close(&q);
+  for (i = 0; i < 2; i++) {
+    pthread_join(cons[i], NULL);
+    total += sums[i];
+  }
+  printf("consumed %ld of %d\n", total, NR_PRODUCERS * NR_BATCHES * BATCH);
+  lqueue_destroy(&q);
+}
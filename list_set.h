@@ -0,0 +1,215 @@
+#ifndef LIST_SET_H_20261018
+#define LIST_SET_H_20261018
+#include "list_sort.h"
+/*
+ * Set operations on lists sorted with list_sort().
+ *
+ * Each operation takes one merge pass over both lists, allocates
+ * nothing and only relinks nodes.  The result is left in @a, @b is
+ * always left empty, and every node that is not part of the result is
+ * appended to @removed so the caller can free them in one batch.
+ *
+ * @cmp must be a three-way comparison, < 0, 0 or > 0, consistent with
+ * the order the lists were sorted in.  Inputs are expected to be sets;
+ * run list_sorted_dedup() first if a list may hold equal elements, or
+ * equal elements are matched one to one.
+ */
+
+/*
+ * Move the entries of @head from @pos to the end onto @list's tail.
+ */
+static void __list_set_move_rest(struct list_head *pos,
+                                 struct list_head *head,
+                                 struct list_head *list) {
+  struct list_head keep;
+
+  if (pos == head) return;
+  list_cut_before(&keep, head, pos);
+  list_splice_tail_init(head, list);
+  list_splice_tail(&keep, head);
+}
+
+/**
+ * list_sorted_dedup - remove adjacent equal elements
+ * @priv: passed to @cmp
+ * @head: the sorted list; the first of each run of equal elements stays
+ * @cmp: three-way comparison
+ * @dups: list the duplicates are appended to
+ *
+ * Returns the number of elements moved to @dups.
+ */
+static size_t list_sorted_dedup(void *priv, struct list_head *head,
+                                list_cmp_func_t cmp, struct list_head *dups) {
+  struct list_head *keep = head->next, *pos, *n;
+  size_t moved = 0;
+
+  if (keep == head) return 0;
+  for (pos = keep->next, n = pos->next; pos != head; pos = n, n = pos->next) {
+    if (cmp(priv, keep, pos) == 0) {
+      list_move_tail(pos, dups);
+      moved++;
+    } else {
+      keep = pos;
+    }
+  }
+  return moved;
+}
+
+/**
+ * list_sorted_union - merge @b into @a, dropping elements already in @a
+ * @priv: passed to @cmp
+ * @a: first sorted set, receives the union
+ * @b: second sorted set, left empty
+ * @cmp: three-way comparison
+ * @removed: list the elements of @b equal to one in @a are appended to
+ *
+ * Equal elements keep the node from @a.  Returns the number of elements
+ * moved to @removed.
+ */
+static size_t list_sorted_union(void *priv, struct list_head *a,
+                                struct list_head *b, list_cmp_func_t cmp,
+                                struct list_head *removed) {
+  struct list_head *pa = a->next, *pb = b->next, *nb;
+  size_t moved = 0;
+  int c;
+
+  while (pa != a && pb != b) {
+    c = cmp(priv, pa, pb);
+    if (c < 0) {
+      pa = pa->next;
+      continue;
+    }
+    nb = pb->next;
+    if (c == 0) {
+      list_move_tail(pb, removed);
+      moved++;
+      pa = pa->next;
+    } else {
+      list_move_tail(pb, pa); /* insert before pa */
+    }
+    pb = nb;
+  }
+  list_splice_tail_init(b, a);
+  return moved;
+}
+
+/**
+ * list_sorted_intersect - keep in @a only the elements also in @b
+ * @priv: passed to @cmp
+ * @a: first sorted set, receives the intersection
+ * @b: second sorted set, left empty
+ * @cmp: three-way comparison
+ * @removed: list every other node of @a and @b is appended to
+ *
+ * The leftover tails are moved with one cut each, without being walked.
+ * Returns the number of elements kept in @a.
+ */
+static size_t list_sorted_intersect(void *priv, struct list_head *a,
+                                    struct list_head *b, list_cmp_func_t cmp,
+                                    struct list_head *removed) {
+  struct list_head *pa = a->next, *pb = b->next, *n;
+  size_t kept = 0;
+  int c;
+
+  while (pa != a && pb != b) {
+    c = cmp(priv, pa, pb);
+    if (c < 0) {
+      n = pa->next;
+      list_move_tail(pa, removed);
+      pa = n;
+    } else {
+      if (c == 0) {
+        pa = pa->next;
+        kept++;
+      }
+      n = pb->next;
+      list_move_tail(pb, removed);
+      pb = n;
+    }
+  }
+  __list_set_move_rest(pa, a, removed);
+  list_splice_tail_init(b, removed);
+  return kept;
+}
+
+/**
+ * list_sorted_difference - remove from @a the elements that are in @b
+ * @priv: passed to @cmp
+ * @a: first sorted set, receives @a minus @b
+ * @b: second sorted set, left empty
+ * @cmp: three-way comparison
+ * @removed: list the dropped nodes of @a and all of @b are appended to
+ *
+ * Returns the number of elements of @a that were dropped.
+ */
+static size_t list_sorted_difference(void *priv, struct list_head *a,
+                                     struct list_head *b, list_cmp_func_t cmp,
+                                     struct list_head *removed) {
+  struct list_head *pa = a->next, *pb = b->next, *n;
+  size_t dropped = 0;
+  int c;
+
+  while (pa != a && pb != b) {
+    c = cmp(priv, pa, pb);
+    if (c < 0) {
+      pa = pa->next;
+      continue;
+    }
+    if (c == 0) {
+      n = pa->next;
+      list_move_tail(pa, removed);
+      pa = n;
+      dropped++;
+    }
+    n = pb->next;
+    list_move_tail(pb, removed);
+    pb = n;
+  }
+  list_splice_tail_init(b, removed);
+  return dropped;
+}
+
+/**
+ * list_sorted_symdiff - keep the elements that are in exactly one set
+ * @priv: passed to @cmp
+ * @a: first sorted set, receives the symmetric difference
+ * @b: second sorted set, left empty
+ * @cmp: three-way comparison
+ * @removed: list the elements found in both sets are appended to, the
+ *    node from @a first
+ *
+ * Returns the number of elements moved to @removed.
+ */
+static size_t list_sorted_symdiff(void *priv, struct list_head *a,
+                                  struct list_head *b, list_cmp_func_t cmp,
+                                  struct list_head *removed) {
+  struct list_head *pa = a->next, *pb = b->next, *n;
+  size_t moved = 0;
+  int c;
+
+  while (pa != a && pb != b) {
+    c = cmp(priv, pa, pb);
+    if (c < 0) {
+      pa = pa->next;
+      continue;
+    }
+    if (c == 0) {
+      n = pa->next;
+      list_move_tail(pa, removed);
+      pa = n;
+      moved++;
+    }
+    n = pb->next;
+    if (c == 0) {
+      list_move_tail(pb, removed);
+      moved++;
+    } else {
+      list_move_tail(pb, pa); /* insert before pa */
+    }
+    pb = n;
+  }
+  list_splice_tail_init(b, a);
+  return moved;
+}
+
+#endif  // LIST_SET_H_20261018
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list_set.h"
+
+struct mystruct {
+  int a;
+  struct list_head list;
+};
+
+static int mycmp(void *priv, struct list_head *a, struct list_head *b) {
+  struct mystruct *pa = list_entry(a, struct mystruct, list);
+  struct mystruct *pb = list_entry(b, struct mystruct, list);
+  return (pa->a > pb->a) - (pa->a < pb->a);
+}
+
+static void build(struct list_head *head, const int *v, int n) {
+  struct mystruct *p;
+  int i;
+  INIT_LIST_HEAD(head);
+  for (i = 0; i < n; i++) {
+    p = (struct mystruct *)malloc(sizeof(struct mystruct));
+    p->a = v[i];
+    list_add_tail(&p->list, head);
+  }
+  list_sort(NULL, head, mycmp);
+}
+
+static void print_free(const char *name, struct list_head *head) {
+  struct mystruct *p, *t;
+  printf("%s:", name);
+  list_for_each_entry_safe(p, t, head, struct mystruct, list) {
+    printf("%d,", p->a);
+    free(p);
+  }
+  printf("\n");
+  INIT_LIST_HEAD(head);
+}
+
+int main() {
+  static const int va[] = {9, 1, 5, 3, 7, 3, 11};
+  static const int vb[] = {4, 5, 6, 7, 8, 12, 0};
+  struct list_head a, b, removed = LIST_HEAD_INIT(removed);
+  size_t n;
+
+  build(&a, va, 7);
+  n = list_sorted_dedup(NULL, &a, mycmp, &removed);
+  printf("dedup %zu\n", n);
+  print_free("dups", &removed);
+  print_free("a", &a);
+
+#define RUN(op)                                                   \
+  build(&a, va, 7);                                               \
+  build(&b, vb, 7);                                               \
+  list_sorted_dedup(NULL, &a, mycmp, &removed);                   \
+  print_free("  dups", &removed);                                 \
+  n = list_sorted_##op(NULL, &a, &b, mycmp, &removed);            \
+  printf(#op " %zu empty b %d\n", n, list_empty(&b));             \
+  print_free("  result", &a);                                     \
+  print_free("  removed", &removed);
+
+  RUN(union)
+  RUN(intersect)
+  RUN(difference)
+  RUN(symdiff)
+}
@@ -0,0 +1,148 @@
+#ifndef LIST_SORT_H_20261018
+#define LIST_SORT_H_20261018
+#include "list.h"
+/*
+ * Stable bottom-up merge sort of a list_head list, after the kernel's
+ * lib/list_sort.c.
+ *
+ * @cmp returns > 0 if @a must sort after @b and <= 0 otherwise, so a
+ * plain "a > b" comparison keeps equal elements in their original order.
+ */
+
+typedef int (*list_cmp_func_t)(void *priv, struct list_head *a,
+                               struct list_head *b);
+
+/*
+ * Returns a list organized in an intermediate format suited
+ * to chaining of merge() calls: null-terminated, no reserved or
+ * sentinel head node, "prev" links not maintained.
+ */
+static struct list_head *__list_sort_merge(void *priv, list_cmp_func_t cmp,
+                                           struct list_head *a,
+                                           struct list_head *b) {
+  struct list_head *head = NULL, **tail = &head;
+
+  for (;;) {
+    /* if equal, take 'a' -- important for sort stability */
+    if (cmp(priv, a, b) <= 0) {
+      *tail = a;
+      tail = &a->next;
+      a = a->next;
+      if (!a) {
+        *tail = b;
+        break;
+      }
+    } else {
+      *tail = b;
+      tail = &b->next;
+      b = b->next;
+      if (!b) {
+        *tail = a;
+        break;
+      }
+    }
+  }
+  return head;
+}
+
+/*
+ * Combine final list merge with restoration of standard doubly-linked
+ * list structure.
+ */
+static void __list_sort_merge_final(void *priv, list_cmp_func_t cmp,
+                                    struct list_head *head,
+                                    struct list_head *a,
+                                    struct list_head *b) {
+  struct list_head *tail = head;
+
+  for (;;) {
+    if (cmp(priv, a, b) <= 0) {
+      tail->next = a;
+      a->prev = tail;
+      tail = a;
+      a = a->next;
+      if (!a) break;
+    } else {
+      tail->next = b;
+      b->prev = tail;
+      tail = b;
+      b = b->next;
+      if (!b) {
+        b = a;
+        break;
+      }
+    }
+  }
+
+  /* Finish linking remainder of list b on to tail */
+  tail->next = b;
+  do {
+    b->prev = tail;
+    tail = b;
+    b = b->next;
+  } while (b);
+
+  tail->next = head;
+  head->prev = tail;
+}
+
+/**
+ * list_sort - sort a list
+ * @priv: private data, opaque to list_sort(), passed to @cmp
+ * @head: the list to sort
+ * @cmp: the elements comparison function
+ *
+ * Pending sublists of size 2^k are merged as soon as a second one of the
+ * same size exists, which keeps merges balanced (at worst 2:1) and the
+ * working set small enough to stay in cache.
+ */
+static void list_sort(void *priv, struct list_head *head,
+                      list_cmp_func_t cmp) {
+  struct list_head *list = head->next, *pending = NULL;
+  size_t count = 0; /* Count of pending */
+
+  if (list == head->prev) /* Zero or one elements */
+    return;
+
+  /* Convert to a null-terminated singly-linked list. */
+  head->prev->next = NULL;
+
+  do {
+    size_t bits;
+    struct list_head **tail = &pending;
+
+    /* Find the least-significant clear bit in count */
+    for (bits = count; bits & 1; bits >>= 1) tail = &(*tail)->prev;
+    /* Do the indicated merge */
+    if (bits) {
+      struct list_head *a = *tail, *b = a->prev;
+
+      a = __list_sort_merge(priv, cmp, b, a);
+      /* Install the merged result in place of the inputs */
+      a->prev = b->prev;
+      *tail = a;
+    }
+
+    /* Move one element from input list to pending */
+    list->prev = pending;
+    pending = list;
+    list = list->next;
+    pending->next = NULL;
+    count++;
+  } while (list);
+
+  /* End of input; merge together all the pending lists. */
+  list = pending;
+  pending = pending->prev;
+  for (;;) {
+    struct list_head *next = pending->prev;
+
+    if (!next) break;
+    list = __list_sort_merge(priv, cmp, pending, list);
+    pending = next;
+  }
+  /* The final merge, rebuilding prev links */
+  __list_sort_merge_final(priv, cmp, head, pending, list);
+}
+
+#endif  // LIST_SORT_H_20261018
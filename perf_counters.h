@@ -0,0 +1,204 @@
+#ifndef PERF_COUNTERS_H_20261018
+#define PERF_COUNTERS_H_20261018
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+/*
+ * Hardware performance counters around a code region, via
+ * perf_event_open(2).
+ *
+ * Every counter is opened on its own rather than as a group, so one
+ * event the CPU or hypervisor does not support does not take the others
+ * down with it.  Counters that cannot be opened (containers, seccomp,
+ * perf_event_paranoid) are marked unavailable and reported as "n/a";
+ * wall-clock time is always measured.  Values are scaled by
+ * time_enabled / time_running when the kernel had to multiplex.
+ */
+
+enum perf_counter_id {
+  PERF_CNT_CYCLES,
+  PERF_CNT_INSTRUCTIONS,
+  PERF_CNT_L1D_MISSES,
+  PERF_CNT_LLC_MISSES,
+  PERF_CNT_DTLB_MISSES,
+  PERF_CNT_BRANCH_MISSES,
+  PERF_CNT_NR,
+};
+
+struct perf_counters {
+  int fd[PERF_CNT_NR];
+  uint64_t value[PERF_CNT_NR];
+  uint64_t wall_ns;
+  struct timespec start;
+  int nr_available;
+};
+
+static const char *const perf_counter_names[PERF_CNT_NR] = {
+    "cycles",     "instructions", "L1D-miss",
+    "LLC-miss",   "dTLB-miss",    "branch-miss",
+};
+
+#define __PERF_CACHE(cache, op, result)                  \
+  ((cache) | ((PERF_COUNT_HW_CACHE_OP_##op) << 8) |      \
+   ((PERF_COUNT_HW_CACHE_RESULT_##result) << 16))
+
+static void __perf_counter_attr(enum perf_counter_id id,
+                                struct perf_event_attr *attr) {
+  memset(attr, 0, sizeof(*attr));
+  attr->size = sizeof(*attr);
+  attr->disabled = 1;
+  attr->exclude_kernel = 1;
+  attr->exclude_hv = 1;
+  attr->read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  switch (id) {
+    case PERF_CNT_CYCLES:
+      attr->type = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PERF_CNT_INSTRUCTIONS:
+      attr->type = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PERF_CNT_L1D_MISSES:
+      attr->type = PERF_TYPE_HW_CACHE;
+      attr->config = __PERF_CACHE(PERF_COUNT_HW_CACHE_L1D, READ, MISS);
+      break;
+    case PERF_CNT_LLC_MISSES:
+      attr->type = PERF_TYPE_HW_CACHE;
+      attr->config = __PERF_CACHE(PERF_COUNT_HW_CACHE_LL, READ, MISS);
+      break;
+    case PERF_CNT_DTLB_MISSES:
+      attr->type = PERF_TYPE_HW_CACHE;
+      attr->config = __PERF_CACHE(PERF_COUNT_HW_CACHE_DTLB, READ, MISS);
+      break;
+    case PERF_CNT_BRANCH_MISSES:
+    default:
+      attr->type = PERF_TYPE_HARDWARE;
+      attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+  }
+}
+
+/**
+ * perf_counters_open - open the counters for the calling thread
+ * @pc: the counter set to open.
+ *
+ * Returns the number of hardware counters available, possibly 0; the
+ * set is usable for wall-clock timing either way.
+ */
+static int perf_counters_open(struct perf_counters *pc) {
+  struct perf_event_attr attr;
+  int i;
+
+  pc->nr_available = 0;
+  pc->wall_ns = 0;
+  for (i = 0; i < PERF_CNT_NR; i++) {
+    __perf_counter_attr((enum perf_counter_id)i, &attr);
+    pc->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    pc->value[i] = 0;
+    if (pc->fd[i] >= 0) pc->nr_available++;
+  }
+  return pc->nr_available;
+}
+
+/**
+ * perf_counters_close - close all counters
+ * @pc: the counter set.
+ */
+static void perf_counters_close(struct perf_counters *pc) {
+  int i;
+
+  for (i = 0; i < PERF_CNT_NR; i++) {
+    if (pc->fd[i] >= 0) close(pc->fd[i]);
+    pc->fd[i] = -1;
+  }
+  pc->nr_available = 0;
+}
+
+/**
+ * perf_counter_available - tests whether a counter could be opened
+ * @pc: the counter set.
+ * @id: the counter.
+ */
+static int perf_counter_available(const struct perf_counters *pc,
+                                  enum perf_counter_id id) {
+  return pc->fd[id] >= 0;
+}
+
+/**
+ * perf_counters_start - reset and start counting
+ * @pc: the counter set.
+ */
+static void perf_counters_start(struct perf_counters *pc) {
+  int i;
+
+  for (i = 0; i < PERF_CNT_NR; i++) {
+    if (pc->fd[i] < 0) continue;
+    ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &pc->start);
+}
+
+/**
+ * perf_counters_stop - stop counting and read the values
+ * @pc: the counter set.
+ */
+static void perf_counters_stop(struct perf_counters *pc) {
+  struct timespec end;
+  uint64_t buf[3];
+  int i;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  for (i = 0; i < PERF_CNT_NR; i++)
+    if (pc->fd[i] >= 0) ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+  pc->wall_ns = (uint64_t)(end.tv_sec - pc->start.tv_sec) * 1000000000 +
+                (uint64_t)(end.tv_nsec - pc->start.tv_nsec);
+  for (i = 0; i < PERF_CNT_NR; i++) {
+    pc->value[i] = 0;
+    if (pc->fd[i] < 0) continue;
+    if (read(pc->fd[i], buf, sizeof(buf)) != sizeof(buf)) continue;
+    /* buf: value, time_enabled, time_running */
+    if (buf[2] && buf[2] < buf[1])
+      pc->value[i] = (uint64_t)((double)buf[0] * buf[1] / buf[2]);
+    else
+      pc->value[i] = buf[0];
+  }
+}
+
+/**
+ * perf_counters_report - print per-operation values for the last region
+ * @pc: the counter set, after perf_counters_stop().
+ * @name: label for the region.
+ * @nr_ops: number of operations the region performed, 0 for totals.
+ * @out: where to print.
+ */
+static void perf_counters_report(const struct perf_counters *pc,
+                                 const char *name, uint64_t nr_ops,
+                                 FILE *out) {
+  double ops = nr_ops ? (double)nr_ops : 1;
+  int i;
+
+  fprintf(out, "%-24s %10.2f ns", name, pc->wall_ns / ops);
+  for (i = 0; i < PERF_CNT_NR; i++) {
+    if (pc->fd[i] >= 0)
+      fprintf(out, "  %s %.3f", perf_counter_names[i], pc->value[i] / ops);
+    else
+      fprintf(out, "  %s n/a", perf_counter_names[i]);
+  }
+  if (pc->fd[PERF_CNT_CYCLES] >= 0 && pc->fd[PERF_CNT_INSTRUCTIONS] >= 0 &&
+      pc->value[PERF_CNT_CYCLES])
+    fprintf(out, "  IPC %.2f",
+            (double)pc->value[PERF_CNT_INSTRUCTIONS] /
+                pc->value[PERF_CNT_CYCLES]);
+  fprintf(out, "%s\n", nr_ops ? " /op" : "");
+}
+
+#endif  // PERF_COUNTERS_H_20261018
@@ -0,0 +1,315 @@
+#ifndef SLIST_H_20261018
+#define SLIST_H_20261018
+#include <stdlib.h>
+
+#include "list.h"
+/*
+ * Singly linked lists, for queues that only push, pop from the front and
+ * iterate forward.  A node is one pointer, half the size of a list_head,
+ * and linking a node writes half as many pointers.
+ *
+ * slist_head is a stack: push and pop at the front.
+ *
+ * stailq_head also tracks the address of the last next pointer, which
+ * gives O(1) append and O(1) concatenation.  An empty stailq_head points
+ * @last at its own @first, so it must not be copied by value; move it
+ * with stailq_splice_tail_init() instead.
+ */
+
+struct slist_node {
+  struct slist_node *next;
+};
+
+struct slist_head {
+  struct slist_node *first;
+};
+
+#define SLIST_HEAD_INIT \
+  { NULL }
+#define SLIST_HEAD(name) struct slist_head name = SLIST_HEAD_INIT
+#define INIT_SLIST_HEAD(ptr) ((ptr)->first = NULL)
+
+/**
+ * slist_empty - tests whether a stack is empty
+ * @h: the stack to test.
+ */
+static int slist_empty(const struct slist_head *h) { return !h->first; }
+
+/**
+ * slist_add_head - push a new_node entry
+ * @n: new_node entry to be added
+ * @h: the stack to push it on
+ */
+static void slist_add_head(struct slist_node *n, struct slist_head *h) {
+  n->next = h->first;
+  h->first = n;
+}
+
+/**
+ * slist_add_after - add a new_node entry after the one specified
+ * @n: new_node entry to be added
+ * @prev: node to add it after
+ */
+static void slist_add_after(struct slist_node *n, struct slist_node *prev) {
+  n->next = prev->next;
+  prev->next = n;
+}
+
+/**
+ * slist_del_head - pop the first entry
+ * @h: the stack to pop from.
+ *
+ * Returns the removed node, or NULL if the stack is empty.
+ */
+static struct slist_node *slist_del_head(struct slist_head *h) {
+  struct slist_node *n = h->first;
+
+  if (n) h->first = n->next;
+  return n;
+}
+
+/**
+ * slist_del_after - remove the entry following @prev
+ * @prev: the node before the one to remove, which must exist.
+ *
+ * Returns the removed node.
+ */
+static struct slist_node *slist_del_after(struct slist_node *prev) {
+  struct slist_node *n = prev->next;
+
+  prev->next = n->next;
+  return n;
+}
+
+/**
+ * slist_move_list - move all entries to another stack
+ * @old: the stack to take entries from, left empty.
+ * @new_node: the stack to move them to, whose entries are lost.
+ */
+static void slist_move_list(struct slist_head *old,
+                            struct slist_head *new_node) {
+  new_node->first = old->first;
+  old->first = NULL;
+}
+
+/**
+ * slist_reverse - reverse a stack in place
+ * @h: the stack to reverse.
+ *
+ * Useful to turn a stack built by slist_add_head() into FIFO order.
+ */
+static void slist_reverse(struct slist_head *h) {
+  struct slist_node *pos = h->first, *prev = NULL, *next;
+
+  while (pos) {
+    next = pos->next;
+    pos->next = prev;
+    prev = pos;
+    pos = next;
+  }
+  h->first = prev;
+}
+
+#define slist_entry(ptr, type, member) container_of(ptr, type, member)
+
+#define slist_entry_safe(ptr, type, member) \
+  ((ptr) ? slist_entry(ptr, type, member) : NULL)
+
+/**
+ * slist_first_entry_or_null - get the first element from a stack
+ * @h:    the stack to take the element from.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the slist_node within the struct.
+ */
+#define slist_first_entry_or_null(h, type, member) \
+  slist_entry_safe((h)->first, type, member)
+
+#define slist_for_each(pos, head) \
+  for (pos = (head)->first; pos; pos = pos->next)
+
+#define slist_for_each_safe(pos, n, head)    \
+  for (pos = (head)->first; pos && ({        \
+                              n = pos->next; \
+                              1;             \
+                            });              \
+       pos = n)
+
+/**
+ * slist_for_each_entry    - iterate over list of given type
+ * @pos:    the type * to use as a loop cursor.
+ * @head:    the head for your list.
+ * @member:    the name of the slist_node within the struct.
+ */
+#define slist_for_each_entry(pos, head, type, member)            \
+  for (pos = slist_entry_safe((head)->first, type, member); pos; \
+       pos = slist_entry_safe((pos)->member.next, type, member))
+
+/**
+ * slist_for_each_entry_safe - iterate over list of given type safe against
+ * removal of list entry
+ * @pos:    the type * to use as a loop cursor.
+ * @n:        another &struct slist_node to use as temporary storage
+ * @head:    the head for your list.
+ * @member:    the name of the slist_node within the struct.
+ */
+#define slist_for_each_entry_safe(pos, n, head, type, member) \
+  for (pos = slist_entry_safe((head)->first, type, member);   \
+       pos && ({                                              \
+         n = pos->member.next;                                \
+         1;                                                   \
+       });                                                    \
+       pos = slist_entry_safe(n, type, member))
+
+/*
+ * Singly linked tail queue.
+ */
+struct stailq_head {
+  struct slist_node *first;
+  struct slist_node **last;
+};
+
+#define STAILQ_HEAD_INIT(name) \
+  { NULL, &(name).first }
+
+#define STAILQ_HEAD(name) struct stailq_head name = STAILQ_HEAD_INIT(name)
+
+/**
+ * INIT_STAILQ_HEAD - Initialize a stailq_head structure
+ * @h: stailq_head structure to be initialized.
+ */
+static void INIT_STAILQ_HEAD(struct stailq_head *h) {
+  h->first = NULL;
+  h->last = &h->first;
+}
+
+/**
+ * stailq_empty - tests whether a tail queue is empty
+ * @h: the queue to test.
+ */
+static int stailq_empty(const struct stailq_head *h) { return !h->first; }
+
+/**
+ * stailq_add_head - add a new_node entry at the front
+ * @n: new_node entry to be added
+ * @h: the queue to add it to
+ */
+static void stailq_add_head(struct slist_node *n, struct stailq_head *h) {
+  n->next = h->first;
+  if (!n->next) h->last = &n->next;
+  h->first = n;
+}
+
+/**
+ * stailq_add_tail - add a new_node entry at the back
+ * @n: new_node entry to be added
+ * @h: the queue to add it to
+ */
+static void stailq_add_tail(struct slist_node *n, struct stailq_head *h) {
+  n->next = NULL;
+  *h->last = n;
+  h->last = &n->next;
+}
+
+/**
+ * stailq_add_after - add a new_node entry after the one specified
+ * @n: new_node entry to be added
+ * @prev: node already on @h to add it after
+ * @h: the queue @prev is on
+ */
+static void stailq_add_after(struct slist_node *n, struct slist_node *prev,
+                             struct stailq_head *h) {
+  n->next = prev->next;
+  if (!n->next) h->last = &n->next;
+  prev->next = n;
+}
+
+/**
+ * stailq_del_head - remove the first entry
+ * @h: the queue to remove from.
+ *
+ * Returns the removed node, or NULL if the queue is empty.
+ */
+static struct slist_node *stailq_del_head(struct stailq_head *h) {
+  struct slist_node *n = h->first;
+
+  if (n) {
+    h->first = n->next;
+    if (!h->first) h->last = &h->first;
+  }
+  return n;
+}
+
+/**
+ * stailq_del_after - remove the entry following @prev
+ * @prev: the node before the one to remove, which must exist.
+ * @h: the queue @prev is on.
+ *
+ * Returns the removed node.
+ */
+static struct slist_node *stailq_del_after(struct slist_node *prev,
+                                           struct stailq_head *h) {
+  struct slist_node *n = prev->next;
+
+  prev->next = n->next;
+  if (!prev->next) h->last = &prev->next;
+  return n;
+}
+
+/**
+ * stailq_splice_tail_init - append one queue to another in O(1)
+ * @list: the queue to append, reinitialised.
+ * @head: the queue to append it to.
+ */
+static void stailq_splice_tail_init(struct stailq_head *list,
+                                    struct stailq_head *head) {
+  if (stailq_empty(list)) return;
+  *head->last = list->first;
+  head->last = list->last;
+  INIT_STAILQ_HEAD(list);
+}
+
+/**
+ * stailq_splice_init - prepend one queue to another in O(1)
+ * @list: the queue to prepend, reinitialised.
+ * @head: the queue to prepend it to.
+ */
+static void stailq_splice_init(struct stailq_head *list,
+                               struct stailq_head *head) {
+  if (stailq_empty(list)) return;
+  *list->last = head->first;
+  if (!head->first) head->last = list->last;
+  head->first = list->first;
+  INIT_STAILQ_HEAD(list);
+}
+
+/**
+ * stailq_first_entry_or_null - get the first element from a queue
+ * @h:    the queue to take the element from.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the slist_node within the struct.
+ */
+#define stailq_first_entry_or_null(h, type, member) \
+  slist_entry_safe((h)->first, type, member)
+
+/**
+ * stailq_last_entry - get the last element from a queue
+ * @h:    the queue to take the element from.
+ * @type:    the type of the struct this is embedded in.
+ * @member:    the name of the slist_node within the struct.
+ *
+ * Note, that queue is expected to be not empty.
+ */
+#define stailq_last_entry(h, type, member) \
+  slist_entry(container_of((h)->last, struct slist_node, next), type, member)
+
+#define stailq_for_each(pos, head) slist_for_each(pos, head)
+
+#define stailq_for_each_safe(pos, n, head) slist_for_each_safe(pos, n, head)
+
+#define stailq_for_each_entry(pos, head, type, member) \
+  slist_for_each_entry(pos, head, type, member)
+
+#define stailq_for_each_entry_safe(pos, n, head, type, member) \
+  slist_for_each_entry_safe(pos, n, head, type, member)
+
+#endif  // SLIST_H_20261018
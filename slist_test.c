@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "slist.h"
+
+struct mystruct {
+  int a;
+  struct slist_node node;
+};
+
+int main() {
+  int i = 0;
+  SLIST_HEAD(stack);
+  STAILQ_HEAD(q1);
+  STAILQ_HEAD(q2);
+  struct slist_node *n;
+  struct mystruct *p;
+
+  for (i = 0; i < 5; i++) {
+    p = (struct mystruct *)malloc(sizeof(struct mystruct));
+    p->a = i;
+    slist_add_head(&p->node, &stack);
+  }
+  slist_for_each_entry(p, &stack, struct mystruct, node) printf("%d,", p->a);
+  printf("\n");
+  slist_reverse(&stack);
+  slist_for_each_entry(p, &stack, struct mystruct, node) printf("%d,", p->a);
+  printf("\n");
+
+  while ((n = slist_del_head(&stack))) {
+    p = slist_entry(n, struct mystruct, node);
+    stailq_add_tail(&p->node, p->a % 2 ? &q2 : &q1);
+  }
+  stailq_splice_tail_init(&q2, &q1);
+  printf("empty %d last %d\n", stailq_empty(&q2),
+         stailq_last_entry(&q1, struct mystruct, node)->a);
+  stailq_for_each_entry(p, &q1, struct mystruct, node) printf("%d,", p->a);
+  printf("\n");
+
+  while ((n = stailq_del_head(&q1)))
+    free(slist_entry(n, struct mystruct, node));
+  printf("empty %d\n", stailq_empty(&q1));
+}
@@ -0,0 +1,413 @@
+#ifndef WAIT_QUEUE_H_20261018
+#define WAIT_QUEUE_H_20261018
+#include <errno.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "list.h"
+/*
+ * Wait queues in the style of the kernel's wait_queue_head_t.
+ *
+ * Waiters are wait_queue_entry nodes embedded in the waiting object and
+ * linked on a list_head.  Non-exclusive waiters are added at the head and
+ * are all woken; exclusive waiters are added at the tail and wake_up_nr()
+ * stops after waking the requested number of them.
+ *
+ * Threads park on a futex word in their entry.  In C++20, co_await on a
+ * wait_queue_awaiter queues the coroutine handle instead, so a suspended
+ * task costs one entry and no thread.  Coroutine entries carry
+ * WQ_FLAG_DEFERRED: they are unlinked under the lock but resumed after it
+ * has been dropped, so a resumed coroutine may wait again straight away.
+ */
+
+#define WQ_FLAG_EXCLUSIVE 0x01
+#define WQ_FLAG_DEFERRED 0x02
+
+struct wait_queue_entry;
+typedef int (*wait_queue_func_t)(struct wait_queue_entry *wq_entry, void *key);
+
+struct wait_queue_entry {
+  unsigned flags;
+  uint32_t woken;
+  void *private_data;
+  wait_queue_func_t func;
+  struct list_head entry;
+};
+
+struct wait_queue_head {
+  pthread_mutex_t lock;
+  struct list_head head;
+};
+
+/**
+ * init_waitqueue_head - initialize a wait queue
+ * @wq_head: the wait queue to initialize.
+ */
+static void init_waitqueue_head(struct wait_queue_head *wq_head) {
+  pthread_mutex_init(&wq_head->lock, NULL);
+  INIT_LIST_HEAD(&wq_head->head);
+}
+
+/**
+ * destroy_waitqueue_head - release a wait queue, which must be empty
+ * @wq_head: the wait queue to destroy.
+ */
+static void destroy_waitqueue_head(struct wait_queue_head *wq_head) {
+  pthread_mutex_destroy(&wq_head->lock);
+}
+
+/**
+ * waitqueue_active - tests whether a wait queue has waiters, locklessly
+ * @wq_head: the wait queue to test.
+ *
+ * Only safe to skip a wake_up() on if the waker's condition update is
+ * ordered before this check.
+ */
+static int waitqueue_active(struct wait_queue_head *wq_head) {
+  return __atomic_load_n(&wq_head->head.next, __ATOMIC_ACQUIRE) !=
+         &wq_head->head;
+}
+
+static long __futex(uint32_t *uaddr, int op, uint32_t val,
+                    const struct timespec *ts) {
+  return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+/**
+ * futex_wake_function - wake function for threads parked on a futex
+ * @wq_entry: the entry being woken.
+ * @key: unused.
+ *
+ * Unlinks the entry before setting the futex word, so the waiter may
+ * return and free it as soon as it sees the word change.
+ */
+static int futex_wake_function(struct wait_queue_entry *wq_entry,
+                               void *key) {
+  list_del_init(&wq_entry->entry);
+  __atomic_store_n(&wq_entry->woken, 1, __ATOMIC_RELEASE);
+  __futex(&wq_entry->woken, FUTEX_WAKE_PRIVATE, 1, NULL);
+  return 1;
+}
+
+/**
+ * init_wait_entry - initialize an entry for a waiting thread
+ * @wq_entry: the entry to initialize.
+ * @flags: 0 or WQ_FLAG_EXCLUSIVE.
+ */
+static void init_wait_entry(struct wait_queue_entry *wq_entry,
+                            unsigned flags) {
+  wq_entry->flags = flags;
+  wq_entry->woken = 0;
+  wq_entry->private_data = NULL;
+  wq_entry->func = futex_wake_function;
+  INIT_LIST_HEAD(&wq_entry->entry);
+}
+
+/**
+ * init_waitqueue_func_entry - initialize an entry with a custom callback
+ * @wq_entry: the entry to initialize.
+ * @func: called on wakeup; with the lock held unless WQ_FLAG_DEFERRED is
+ *    set, in which case the entry has already been unlinked.
+ * @private_data: stored in the entry for @func.
+ */
+static void init_waitqueue_func_entry(struct wait_queue_entry *wq_entry,
+                                      wait_queue_func_t func,
+                                      void *private_data) {
+  wq_entry->flags = 0;
+  wq_entry->woken = 0;
+  wq_entry->private_data = private_data;
+  wq_entry->func = func;
+  INIT_LIST_HEAD(&wq_entry->entry);
+}
+
+static void __add_wait_queue(struct wait_queue_head *wq_head,
+                             struct wait_queue_entry *wq_entry) {
+  if (wq_entry->flags & WQ_FLAG_EXCLUSIVE)
+    list_add_tail(&wq_entry->entry, &wq_head->head);
+  else
+    list_add(&wq_entry->entry, &wq_head->head);
+}
+
+/**
+ * add_wait_queue - add a non-exclusive waiter
+ * @wq_head: the wait queue.
+ * @wq_entry: the entry to add.
+ */
+static void add_wait_queue(struct wait_queue_head *wq_head,
+                           struct wait_queue_entry *wq_entry) {
+  wq_entry->flags &= ~WQ_FLAG_EXCLUSIVE;
+  pthread_mutex_lock(&wq_head->lock);
+  __add_wait_queue(wq_head, wq_entry);
+  pthread_mutex_unlock(&wq_head->lock);
+}
+
+/**
+ * add_wait_queue_exclusive - add an exclusive waiter
+ * @wq_head: the wait queue.
+ * @wq_entry: the entry to add.
+ */
+static void add_wait_queue_exclusive(struct wait_queue_head *wq_head,
+                                     struct wait_queue_entry *wq_entry) {
+  wq_entry->flags |= WQ_FLAG_EXCLUSIVE;
+  pthread_mutex_lock(&wq_head->lock);
+  __add_wait_queue(wq_head, wq_entry);
+  pthread_mutex_unlock(&wq_head->lock);
+}
+
+/**
+ * remove_wait_queue - remove a waiter if it is still queued
+ * @wq_head: the wait queue.
+ * @wq_entry: the entry to remove.
+ */
+static void remove_wait_queue(struct wait_queue_head *wq_head,
+                              struct wait_queue_entry *wq_entry) {
+  pthread_mutex_lock(&wq_head->lock);
+  list_del_init(&wq_entry->entry);
+  pthread_mutex_unlock(&wq_head->lock);
+}
+
+/**
+ * __wake_up - wake waiters
+ * @wq_head: the wait queue.
+ * @nr_exclusive: number of exclusive waiters to wake, 0 for all of them.
+ * @key: passed to the wake functions.
+ *
+ * Every non-exclusive waiter ahead of the last exclusive one woken is
+ * woken too.  Returns the number of waiters woken.
+ */
+static int __wake_up(struct wait_queue_head *wq_head, int nr_exclusive,
+                     void *key) {
+  struct list_head deferred = LIST_HEAD_INIT(deferred);
+  struct wait_queue_entry *curr, *next;
+  unsigned flags;
+  int ret, woken = 0;
+
+  pthread_mutex_lock(&wq_head->lock);
+  list_for_each_entry_safe(curr, next, &wq_head->head,
+                           struct wait_queue_entry, entry) {
+    flags = curr->flags;
+    if (flags & WQ_FLAG_DEFERRED) {
+      list_move_tail(&curr->entry, &deferred);
+      ret = 1;
+    } else {
+      ret = curr->func(curr, key);
+    }
+    if (ret < 0) break;
+    woken += ret;
+    if (ret && (flags & WQ_FLAG_EXCLUSIVE) && !--nr_exclusive) break;
+  }
+  pthread_mutex_unlock(&wq_head->lock);
+
+  list_for_each_entry_safe(curr, next, &deferred, struct wait_queue_entry,
+                           entry) {
+    list_del_init(&curr->entry);
+    curr->func(curr, key);
+  }
+  return woken;
+}
+
+#define wake_up(wq_head) __wake_up(wq_head, 1, NULL)
+#define wake_up_nr(wq_head, nr) __wake_up(wq_head, nr, NULL)
+#define wake_up_all(wq_head) __wake_up(wq_head, 0, NULL)
+
+/**
+ * prepare_to_wait - queue a thread entry before checking the condition
+ * @wq_head: the wait queue.
+ * @wq_entry: an entry set up by init_wait_entry().
+ *
+ * Clears the futex word, so a wakeup that races with the condition check
+ * makes the following wait_entry_sleep() return at once.
+ */
+static void prepare_to_wait(struct wait_queue_head *wq_head,
+                            struct wait_queue_entry *wq_entry) {
+  pthread_mutex_lock(&wq_head->lock);
+  __atomic_store_n(&wq_entry->woken, 0, __ATOMIC_RELAXED);
+  if (list_empty(&wq_entry->entry)) __add_wait_queue(wq_head, wq_entry);
+  pthread_mutex_unlock(&wq_head->lock);
+}
+
+/**
+ * finish_wait - dequeue a thread entry after the wait is over
+ * @wq_head: the wait queue.
+ * @wq_entry: the entry.
+ */
+static void finish_wait(struct wait_queue_head *wq_head,
+                        struct wait_queue_entry *wq_entry) {
+  /*
+   * Always take the lock: a waker may still be inside
+   * futex_wake_function() for this entry even though it is unlinked.
+   */
+  remove_wait_queue(wq_head, wq_entry);
+}
+
+/**
+ * wait_entry_sleep - park the calling thread until its entry is woken
+ * @wq_entry: an entry queued by prepare_to_wait().
+ * @timeout_ms: maximum time to sleep, negative for no limit.
+ *
+ * May return early on a spurious wakeup.  Returns 0, or -ETIMEDOUT.
+ */
+static int wait_entry_sleep(struct wait_queue_entry *wq_entry,
+                            long timeout_ms) {
+  struct timespec ts, *tsp = NULL;
+
+  if (timeout_ms >= 0) {
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+    tsp = &ts;
+  }
+  if (__atomic_load_n(&wq_entry->woken, __ATOMIC_ACQUIRE)) return 0;
+  if (__futex(&wq_entry->woken, FUTEX_WAIT_PRIVATE, 0, tsp) &&
+      errno == ETIMEDOUT)
+    return -ETIMEDOUT;
+  return 0;
+}
+
+static long __wait_now_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+#define ___wait_event(wq_head, condition, flags, timeout_ms)         \
+  ({                                                                 \
+    struct wait_queue_entry __wq_entry;                              \
+    long __timeout = (timeout_ms);                                   \
+    long __deadline = __wait_now_ms() + __timeout;                   \
+    int __ret = 1;                                                   \
+    init_wait_entry(&__wq_entry, flags);                             \
+    for (;;) {                                                       \
+      prepare_to_wait(wq_head, &__wq_entry);                         \
+      if (condition) break;                                          \
+      if (__timeout >= 0 && (__timeout = __deadline -                \
+                                         __wait_now_ms()) <= 0) {    \
+        __ret = (condition) ? 1 : 0;                                 \
+        break;                                                       \
+      }                                                              \
+      wait_entry_sleep(&__wq_entry, __timeout);                      \
+    }                                                                \
+    finish_wait(wq_head, &__wq_entry);                               \
+    __ret;                                                           \
+  })
+
+/**
+ * wait_event - sleep until a condition gets true
+ * @wq_head: the wait queue to wait on.
+ * @condition: a C expression for the event to wait for.
+ *
+ * The condition is rechecked each time the wait queue is woken.
+ */
+#define wait_event(wq_head, condition) \
+  ((void)___wait_event(wq_head, condition, 0, -1))
+
+/**
+ * wait_event_exclusive - sleep as an exclusive waiter until a condition
+ * @wq_head: the wait queue to wait on.
+ * @condition: a C expression for the event to wait for.
+ */
+#define wait_event_exclusive(wq_head, condition) \
+  ((void)___wait_event(wq_head, condition, WQ_FLAG_EXCLUSIVE, -1))
+
+/**
+ * wait_event_timeout - sleep until a condition gets true or time elapses
+ * @wq_head: the wait queue to wait on.
+ * @condition: a C expression for the event to wait for.
+ * @timeout_ms: timeout in milliseconds.
+ *
+ * Returns 1 if @condition was true, 0 if the timeout elapsed.
+ */
+#define wait_event_timeout(wq_head, condition, timeout_ms) \
+  ___wait_event(wq_head, condition, 0, timeout_ms)
+
+#if defined(__cplusplus) && __cplusplus >= 202002L
+#include <coroutine>
+
+/*
+ * co_await wait_queue_awaiter{&wq} suspends the coroutine until the next
+ * wake_up*() that reaches it, and resumes it on the waking thread.
+ */
+struct wait_queue_awaiter {
+  struct wait_queue_head *wq_head;
+  unsigned flags;
+  struct wait_queue_entry wq_entry;
+
+  explicit wait_queue_awaiter(struct wait_queue_head *wq,
+                              bool exclusive = false)
+      : wq_head(wq), flags(exclusive ? WQ_FLAG_EXCLUSIVE : 0) {}
+
+  static int resume_function(struct wait_queue_entry *wq_entry, void *key) {
+    std::coroutine_handle<>::from_address(wq_entry->private_data).resume();
+    return 1;
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) noexcept {
+    init_waitqueue_func_entry(&wq_entry, resume_function, h.address());
+    wq_entry.flags = flags | WQ_FLAG_DEFERRED;
+    pthread_mutex_lock(&wq_head->lock);
+    __add_wait_queue(wq_head, &wq_entry);
+    pthread_mutex_unlock(&wq_head->lock);
+  }
+
+  void await_resume() const noexcept {}
+};
+
+/*
+ * co_await wait_event_awaiter(&wq, pred) completes once pred() is true.
+ * The predicate is rechecked under the wait queue lock after queueing,
+ * so a wake_up() that follows a condition update cannot be lost.
+ */
+template <class Pred>
+struct wait_event_awaiter {
+  struct wait_queue_head *wq_head;
+  Pred pred;
+  unsigned flags;
+  struct wait_queue_entry wq_entry;
+
+  wait_event_awaiter(struct wait_queue_head *wq, Pred p, bool exclusive)
+      : wq_head(wq), pred(p), flags(exclusive ? WQ_FLAG_EXCLUSIVE : 0) {}
+
+  bool await_ready() { return pred(); }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    init_waitqueue_func_entry(&wq_entry, requeue_function, this);
+    wq_entry.flags = flags | WQ_FLAG_DEFERRED;
+    handle = h;
+    pthread_mutex_lock(&wq_head->lock);
+    __add_wait_queue(wq_head, &wq_entry);
+    if (pred()) {
+      list_del_init(&wq_entry.entry);
+      pthread_mutex_unlock(&wq_head->lock);
+      return false;
+    }
+    pthread_mutex_unlock(&wq_head->lock);
+    return true;
+  }
+
+  void await_resume() const noexcept {}
+
+ private:
+  std::coroutine_handle<> handle;
+
+  /* Resume if the predicate holds, otherwise queue up again. */
+  static int requeue_function(struct wait_queue_entry *wq_entry, void *key) {
+    auto *self = static_cast<wait_event_awaiter *>(wq_entry->private_data);
+    if (!self->await_suspend(self->handle)) self->handle.resume();
+    return 1;
+  }
+};
+
+template <class Pred>
+wait_event_awaiter<Pred> wait_event_co(struct wait_queue_head *wq_head,
+                                       Pred pred, bool exclusive = false) {
+  return wait_event_awaiter<Pred>(wq_head, pred, exclusive);
+}
+#endif
+
+#endif  // WAIT_QUEUE_H_20261018
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "wait_queue.h"
+
+#define NR_THREADS 4
+#define NR_TASKS 1000
+
+static struct wait_queue_head wq;
+static int tokens;
+static int done;
+static int never;
+
+/* claim one token; fails only when none are left */
+static int take_token(void) {
+  int n = __atomic_load_n(&tokens, __ATOMIC_ACQUIRE);
+  while (n > 0)
+    if (__atomic_compare_exchange_n(&tokens, &n, n - 1, 0, __ATOMIC_ACQ_REL,
+                                    __ATOMIC_ACQUIRE))
+      return 1;
+  return 0;
+}
+
+static void *worker(void *arg) {
+  int taken = 0;
+  for (;;) {
+    wait_event_exclusive(&wq, __atomic_load_n(&tokens, __ATOMIC_ACQUIRE) > 0 ||
+                                  __atomic_load_n(&done, __ATOMIC_ACQUIRE));
+    if (take_token()) {
+      taken++;
+      continue;
+    }
+    if (__atomic_load_n(&done, __ATOMIC_ACQUIRE)) break;
+  }
+  *(int *)arg = taken;
+  return NULL;
+}
+
+struct task {
+  struct promise_type {
+    task get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { abort(); }
+  };
+};
+
+static int resumed;
+static int generation;
+
+static task waiter() {
+  co_await wait_queue_awaiter(&wq, true);
+  resumed++;
+  co_await wait_event_co(&wq, [] { return generation >= 2; });
+  resumed++;
+}
+
+int main() {
+  int i, taken[NR_THREADS], total = 0;
+  pthread_t th[NR_THREADS];
+
+  init_waitqueue_head(&wq);
+  for (i = 0; i < NR_THREADS; i++)
+    pthread_create(&th[i], NULL, worker, &taken[i]);
+  for (i = 0; i < 10000; i++) {
+    __atomic_add_fetch(&tokens, 1, __ATOMIC_ACQ_REL);
+    wake_up(&wq);
+  }
+  printf("timed out %d\n", !wait_event_timeout(&wq, never, 20));
+  __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+  wake_up_all(&wq);
+  for (i = 0; i < NR_THREADS; i++) {
+    pthread_join(th[i], NULL);
+    total += taken[i];
+  }
+  printf("threads took %d tokens\n", total);
+
+  for (i = 0; i < NR_TASKS; i++) waiter();
+  printf("suspended, resumed %d\n", resumed);
+  i = wake_up_nr(&wq, 10);
+  printf("woken %d, resumed %d\n", i, resumed);
+  i = wake_up_all(&wq);
+  printf("woken %d, resumed %d\n", i, resumed);
+  generation = 2;
+  i = wake_up_all(&wq);
+  printf("woken %d, resumed %d\n", i, resumed);
+  destroy_waitqueue_head(&wq);
+}